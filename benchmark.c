@@ -0,0 +1,370 @@
+#include "grafo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+/*
+ * Benchmark das operações do grafo sobre mapas sintéticos.
+ *
+ *   ./benchmark [opções]
+ *     --linhas N        linhas do mapa (omissão 1000)
+ *     --colunas N       colunas do mapa (omissão 1000)
+ *     --densidade P     probabilidade de uma célula ter antena (omissão 0.05)
+ *     --frequencias F   número de frequências distintas, 1..93 (omissão 26)
+ *     --assimetria S    expoente Zipf da distribuição das frequências (0 = uniforme)
+ *     --semente N       semente do gerador (omissão 1)
+ *     --repeticoes N    repetições de cada operação (omissão 20)
+ *     --saltos N        limite de saltos de encontrar_caminhos (omissão 3)
+ *     --max-caminhos N  limite de caminhos por chamada (omissão 100000)
+ *     --mapa FICHEIRO   onde escrever o mapa gerado (omissão benchmark_mapa.txt)
+ *
+ * Cada operação produz uma linha JSON no stdout com a latência (média,
+ * p50, p90, p99, máximo, em microssegundos) e o débito; a última linha
+ * resume o mapa e o pico de memória do processo.
+ */
+
+typedef struct {
+    int linhas, colunas;
+    double densidade;
+    int frequencias;
+    double assimetria;
+    unsigned long long semente;
+    int repeticoes;
+    int saltos;
+    long long max_caminhos;
+    const char* mapa;
+} Configuracao;
+
+// Símbolos usados como frequências (nenhum é '.', nem espaço, nem fim de linha).
+static const char SIMBOLOS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789!\"#$%&'()*+,-/:;<=>?@[\\]^_`{|}~";
+
+// Contadores atualizados pelos callbacks das operações medidas.
+long long contador = 0;
+
+void contar_antena(Antena* a) {
+    (void)a;
+    contador++;
+}
+
+void contar_caminho(Antena** caminho, int tamanho) {
+    (void)caminho;
+    (void)tamanho;
+    contador++;
+}
+
+void contar_intersecao(Antena* a, Antena* b) {
+    (void)a;
+    (void)b;
+    contador++;
+}
+
+// ----------------------------
+// GERADOR
+// ----------------------------
+
+unsigned long long estado_rng;
+
+unsigned long long proximo_aleatorio() {
+    // xorshift64*
+    estado_rng ^= estado_rng >> 12;
+    estado_rng ^= estado_rng << 25;
+    estado_rng ^= estado_rng >> 27;
+    return estado_rng * 0x2545F4914F6CDD1DULL;
+}
+
+double aleatorio_unitario() {
+    return (proximo_aleatorio() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * Escreve um mapa sintético: cada célula tem uma antena com probabilidade
+ * `densidade`, e a frequência de rank r é escolhida com peso 1/(r+1)^assimetria.
+ * Devolve o número de antenas geradas, ou -1 se não foi possível escrever.
+ */
+long long gerar_mapa(const Configuracao* cfg) {
+    FILE* file = fopen(cfg->mapa, "wb");
+    if (!file) return -1;
+
+    double acumulado[sizeof(SIMBOLOS)];
+    double total = 0;
+    for (int r = 0; r < cfg->frequencias; r++) {
+        total += 1.0 / pow(r + 1, cfg->assimetria);
+        acumulado[r] = total;
+    }
+
+    char* linha = (char*)malloc((size_t)cfg->colunas + 1);
+    if (!linha) {
+        fclose(file);
+        return -1;
+    }
+    long long antenas = 0;
+    for (int y = 0; y < cfg->linhas; y++) {
+        for (int x = 0; x < cfg->colunas; x++) {
+            linha[x] = '.';
+            if (aleatorio_unitario() >= cfg->densidade) continue;
+            double alvo = aleatorio_unitario() * total;
+            int r = 0;
+            while (r < cfg->frequencias - 1 && acumulado[r] < alvo) r++;
+            linha[x] = SIMBOLOS[r];
+            antenas++;
+        }
+        linha[cfg->colunas] = '\n';
+        fwrite(linha, 1, (size_t)cfg->colunas + 1, file);
+    }
+    free(linha);
+    return fclose(file) == 0 ? antenas : -1;
+}
+
+// ----------------------------
+// MEDIÇÃO
+// ----------------------------
+
+double agora_us() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int comparar_latencias(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Escreve uma linha JSON com as estatísticas de uma operação. `elementos`
+ * é o total de unidades processadas em todas as repetições (antenas,
+ * caminhos, pares, bytes), indicadas por `unidade`.
+ */
+void reportar(const char* operacao, double* latencias, int n, long long elementos, const char* unidade) {
+    if (n <= 0) return;
+    double total = 0;
+    for (int i = 0; i < n; i++) total += latencias[i];
+    qsort(latencias, n, sizeof(double), comparar_latencias);
+    printf("{\"operacao\":\"%s\",\"repeticoes\":%d,\"media_us\":%.2f,\"p50_us\":%.2f,\"p90_us\":%.2f,"
+           "\"p99_us\":%.2f,\"max_us\":%.2f,\"ops_s\":%.2f,\"elementos\":%lld,\"unidade\":\"%s\",\"elementos_s\":%.2f}\n",
+           operacao, n, total / n, latencias[n / 2], latencias[(int)(n * 0.9)], latencias[(int)(n * 0.99)],
+           latencias[n - 1], total > 0 ? n / (total / 1e6) : 0, elementos, unidade,
+           total > 0 ? elementos / (total / 1e6) : 0);
+    fflush(stdout);
+}
+
+// Pico de memória residente do processo, em KiB (-1 se não disponível).
+long pico_memoria_kib() {
+#ifndef _WIN32
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) == 0) return uso.ru_maxrss;
+#endif
+    return -1;
+}
+
+// Escolhe uma antena ao acaso (NULL se o grafo está vazio).
+Antena* antena_aleatoria(Grafo* grafo) {
+    if (grafo->num_vertices == 0) return NULL;
+    return grafo->indice[proximo_aleatorio() % (unsigned long long)grafo->num_vertices];
+}
+
+/*
+ * Mede todas as operações sobre o mapa já gerado. Devolve 0 em caso de
+ * sucesso.
+ */
+int medir(const Configuracao* cfg) {
+    int r = cfg->repeticoes;
+    double* latencias = (double*)malloc(r * sizeof(double));
+    char binario[1024];
+    snprintf(binario, sizeof(binario), "%s.bin", cfg->mapa);
+    if (!latencias) return 1;
+
+    // Carregamento do texto.
+    long long elementos = 0;
+    for (int i = 0; i < r; i++) {
+        double t0 = agora_us();
+        Grafo* g = carregar_grafo_arquivo(cfg->mapa);
+        latencias[i] = agora_us() - t0;
+        if (!g) {
+            free(latencias);
+            return 1;
+        }
+        elementos += g->num_vertices;
+        destruir_grafo(g);
+    }
+    reportar("carregar_grafo_arquivo", latencias, r, elementos, "antenas");
+
+    Grafo* grafo = carregar_grafo_arquivo(cfg->mapa);
+    if (!grafo) {
+        free(latencias);
+        return 1;
+    }
+
+    elementos = 0;
+    for (int i = 0; i < r; i++) {
+        double t0 = agora_us();
+        conectar_antenas(grafo);
+        latencias[i] = agora_us() - t0;
+        elementos += grafo->num_vertices;
+    }
+    reportar("conectar_antenas", latencias, r, elementos, "antenas");
+
+    // Travessias a partir de antenas aleatórias.
+    const char* nomes[2] = {"bfs", "dfs"};
+    for (int t = 0; t < 2 && grafo->num_vertices > 0; t++) {
+        contador = 0;
+        for (int i = 0; i < r; i++) {
+            Antena* inicio = antena_aleatoria(grafo);
+            double t0 = agora_us();
+            if (t == 0) bfs(grafo, inicio, contar_antena);
+            else dfs(grafo, inicio, contar_antena);
+            latencias[i] = agora_us() - t0;
+        }
+        reportar(nomes[t], latencias, r, contador, "antenas");
+    }
+
+    // Tabela de saltos a partir de 64 antenas aleatórias (um lote da BFS de várias fontes).
+    int* distancias = (int*)malloc(64 * (size_t)grafo->num_vertices * sizeof(int));
+    if (distancias && grafo->num_vertices > 0) {
+        Antena* fontes[64];
+        elementos = 0;
+        for (int i = 0; i < r; i++) {
+            for (int s = 0; s < 64; s++) fontes[s] = antena_aleatoria(grafo);
+            double t0 = agora_us();
+            bfs_multiplas_fontes(grafo, fontes, 64, distancias);
+            latencias[i] = agora_us() - t0;
+            elementos += 64;
+        }
+        reportar("bfs_multiplas_fontes", latencias, r, elementos, "fontes");
+    }
+    free(distancias);
+
+    // Caminhos entre duas antenas da mesma frequência, com limites.
+    if (grafo->num_vertices > 0) {
+        LimitesCaminhos limites = {cfg->saltos, cfg->max_caminhos};
+        contador = 0;
+        for (int i = 0; i < r; i++) {
+            Antena* origem = antena_aleatoria(grafo);
+            const int* ids;
+            int k = membros_componente(grafo, componente_antena(grafo, origem), &ids);
+            Antena* destino = grafo->indice[ids[proximo_aleatorio() % (unsigned long long)k]];
+            double t0 = agora_us();
+            encontrar_caminhos_limitado(grafo, origem, destino, &limites, contar_caminho);
+            latencias[i] = agora_us() - t0;
+        }
+        reportar("encontrar_caminhos", latencias, r, contador, "caminhos");
+    }
+
+    // Intersecções entre pares de frequências aleatórios.
+    if (cfg->frequencias > 1) {
+        contador = 0;
+        for (int i = 0; i < r; i++) {
+            int a = (int)(proximo_aleatorio() % (unsigned long long)cfg->frequencias);
+            int b = (int)(proximo_aleatorio() % (unsigned long long)(cfg->frequencias - 1));
+            if (b >= a) b++;
+            double t0 = agora_us();
+            listar_intersecoes(grafo, SIMBOLOS[a], SIMBOLOS[b], contar_intersecao);
+            latencias[i] = agora_us() - t0;
+        }
+        reportar("listar_intersecoes", latencias, r, contador, "pares");
+    }
+
+    // Relatório completo: todos os pares de frequências de uma vez.
+    elementos = 0;
+    for (int i = 0; i < r; i++) {
+        double t0 = agora_us();
+        long long pares = listar_todas_intersecoes(grafo, NULL);
+        latencias[i] = agora_us() - t0;
+        if (pares > 0) elementos += pares;
+    }
+    reportar("listar_todas_intersecoes", latencias, r, elementos, "pares");
+
+    // Formato binário.
+    elementos = 0;
+    for (int i = 0; i < r; i++) {
+        double t0 = agora_us();
+        bool ok = salvar_grafo_binario(grafo, binario);
+        latencias[i] = agora_us() - t0;
+        if (!ok) break;
+        FILE* f = fopen(binario, "rb");
+        if (f) {
+            fseek(f, 0, SEEK_END);
+            elementos += ftell(f);
+            fclose(f);
+        }
+    }
+    reportar("salvar_grafo_binario", latencias, r, elementos, "bytes");
+
+    elementos = 0;
+    for (int i = 0; i < r; i++) {
+        double t0 = agora_us();
+        Grafo* g = carregar_grafo_binario(binario);
+        latencias[i] = agora_us() - t0;
+        if (!g) break;
+        elementos += g->num_vertices;
+        destruir_grafo(g);
+    }
+    reportar("carregar_grafo_binario", latencias, r, elementos, "antenas");
+    remove(binario);
+
+    printf("{\"resumo\":true,\"linhas\":%d,\"colunas\":%d,\"densidade\":%.4f,\"frequencias\":%d,\"assimetria\":%.2f,"
+           "\"antenas\":%d,\"arestas\":%lld,\"componentes\":%d,\"pico_memoria_kib\":%ld}\n",
+           cfg->linhas, cfg->colunas, cfg->densidade, cfg->frequencias, cfg->assimetria, grafo->num_vertices,
+           grafo->num_arestas, grafo->num_componentes, pico_memoria_kib());
+
+    destruir_grafo(grafo);
+    free(latencias);
+    return 0;
+}
+
+// ----------------------------
+// MAIN
+// ----------------------------
+
+int main(int argc, char** argv) {
+    Configuracao cfg = {1000, 1000, 0.05, 26, 0.0, 1, 20, 3, 100000, "benchmark_mapa.txt"};
+
+    for (int i = 1; i < argc; i++) {
+        const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!valor) {
+            fprintf(stderr, "Falta o valor de %s\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--linhas") == 0) cfg.linhas = atoi(valor);
+        else if (strcmp(argv[i], "--colunas") == 0) cfg.colunas = atoi(valor);
+        else if (strcmp(argv[i], "--densidade") == 0) cfg.densidade = atof(valor);
+        else if (strcmp(argv[i], "--frequencias") == 0) cfg.frequencias = atoi(valor);
+        else if (strcmp(argv[i], "--assimetria") == 0) cfg.assimetria = atof(valor);
+        else if (strcmp(argv[i], "--semente") == 0) cfg.semente = strtoull(valor, NULL, 10);
+        else if (strcmp(argv[i], "--repeticoes") == 0) cfg.repeticoes = atoi(valor);
+        else if (strcmp(argv[i], "--saltos") == 0) cfg.saltos = atoi(valor);
+        else if (strcmp(argv[i], "--max-caminhos") == 0) cfg.max_caminhos = atoll(valor);
+        else if (strcmp(argv[i], "--mapa") == 0) cfg.mapa = valor;
+        else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (cfg.linhas <= 0 || cfg.colunas <= 0 || cfg.repeticoes <= 0 || cfg.densidade < 0 || cfg.densidade > 1 ||
+        cfg.frequencias < 1 || cfg.frequencias > (int)sizeof(SIMBOLOS) - 1) {
+        fprintf(stderr, "Configuração inválida.\n");
+        return 1;
+    }
+    estado_rng = cfg.semente ? cfg.semente : 1;
+
+    double t0 = agora_us();
+    long long antenas = gerar_mapa(&cfg);
+    if (antenas < 0) {
+        fprintf(stderr, "Erro ao escrever o mapa %s\n", cfg.mapa);
+        return 1;
+    }
+    fprintf(stderr, "mapa %s: %dx%d, %lld antenas, gerado em %.1f ms\n", cfg.mapa, cfg.linhas, cfg.colunas,
+            antenas, (agora_us() - t0) / 1e3);
+
+    if (medir(&cfg) != 0) {
+        fprintf(stderr, "Erro ao medir o mapa %s\n", cfg.mapa);
+        return 1;
+    }
+    return 0;
+}
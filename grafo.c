@@ -5,6 +5,171 @@
 
 #include "grafo.h"
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_thread_num() 0
+#define omp_get_num_threads() 1
+#define omp_get_max_threads() 1
+#endif
+
+#ifdef GRAFO_ESTATISTICAS
+#include <time.h>
+
+/**
+ * @brief Relógio usado pelas estatísticas, em nanossegundos.
+ */
+long long relogio_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Regista uma chamada terminada de uma operação.
+ * @param operacao Estatística da operação.
+ * @param inicio Instante de início (relogio_ns).
+ */
+void registar_operacao(OperacaoEstatistica* operacao, long long inicio) {
+    long long duracao = relogio_ns() - inicio;
+    __atomic_fetch_add(&operacao->chamadas, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&operacao->tempo_total_ns, duracao, __ATOMIC_RELAXED);
+    long long maximo = __atomic_load_n(&operacao->tempo_max_ns, __ATOMIC_RELAXED);
+    while (duracao > maximo &&
+           !__atomic_compare_exchange_n(&operacao->tempo_max_ns, &maximo, duracao, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+#define ESTATISTICA_SOMAR(grafo, campo, valor) \
+    __atomic_fetch_add(&(grafo)->estatisticas.campo, (long long)(valor), __ATOMIC_RELAXED)
+#define ESTATISTICA_INICIO(inicio) long long inicio = relogio_ns()
+#define ESTATISTICA_FIM(grafo, operacao, inicio) registar_operacao(&(grafo)->estatisticas.operacao, inicio)
+#else
+#define ESTATISTICA_SOMAR(grafo, campo, valor) ((void)0)
+#define ESTATISTICA_INICIO(inicio) ((void)0)
+#define ESTATISTICA_FIM(grafo, operacao, inicio) ((void)0)
+#endif
+
+/**
+ * @brief Mapeia um ficheiro em memória só de leitura.
+ *
+ * Em sistemas POSIX usa mmap; nos restantes lê o ficheiro inteiro para um
+ * buffer. Com @p escrita as páginas podem ser alteradas em memória (cópia
+ * privada), sem nunca modificar o ficheiro.
+ * @param filename Caminho do ficheiro.
+ * @param ficheiro Recebe o mapeamento.
+ * @param escrita true para permitir escrita na cópia privada.
+ * @return false se o ficheiro não pôde ser aberto ou lido.
+ */
+bool mapear_ficheiro(const char* filename, FicheiroMapeado* ficheiro, bool escrita) {
+    ficheiro->dados = NULL;
+    ficheiro->tamanho = 0;
+    ficheiro->mapeado = false;
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    ficheiro->tamanho = (size_t)info.st_size;
+    if (ficheiro->tamanho > 0) {
+        int protecao = escrita ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* dados = mmap(NULL, ficheiro->tamanho, protecao, MAP_PRIVATE, fd, 0);
+        if (dados == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(dados, ficheiro->tamanho, MADV_SEQUENTIAL);
+        ficheiro->dados = (char*)dados;
+        ficheiro->mapeado = true;
+    }
+    close(fd);
+    return true;
+#else
+    (void)escrita;
+    FILE* file = fopen(filename, "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long tamanho = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (tamanho > 0) {
+        ficheiro->dados = (char*)malloc((size_t)tamanho);
+        if (!ficheiro->dados || fread(ficheiro->dados, 1, (size_t)tamanho, file) != (size_t)tamanho) {
+            free(ficheiro->dados);
+            ficheiro->dados = NULL;
+            fclose(file);
+            return false;
+        }
+        ficheiro->tamanho = (size_t)tamanho;
+    }
+    fclose(file);
+    return true;
+#endif
+}
+
+/**
+ * @brief Liberta um ficheiro mapeado com mapear_ficheiro.
+ */
+void desmapear_ficheiro(FicheiroMapeado* ficheiro) {
+#ifndef _WIN32
+    if (ficheiro->mapeado) {
+        munmap(ficheiro->dados, ficheiro->tamanho);
+    } else {
+        free(ficheiro->dados);
+    }
+#else
+    free(ficheiro->dados);
+#endif
+    ficheiro->dados = NULL;
+    ficheiro->tamanho = 0;
+}
+
+/**
+ * @struct BlocoAntenas
+ * @brief Bloco contíguo de antenas da arena do grafo.
+ */
+typedef struct BlocoAntenas {
+    struct BlocoAntenas* prox; /**< Bloco alocado anteriormente. */
+    int usadas;                /**< Antenas já entregues deste bloco. */
+    int capacidade;            /**< Número de antenas do bloco. */
+    Antena antenas[];          /**< Armazenamento das antenas. */
+} BlocoAntenas;
+
+#define BLOCO_ANTENAS_MIN 256        /**< Capacidade do primeiro bloco da arena. */
+#define BLOCO_ANTENAS_MAX (1 << 16)  /**< Limite do crescimento geométrico dos blocos. */
+
+/**
+ * @brief Acrescenta à arena um bloco com espaço para pelo menos @p minimo antenas.
+ * @param grafo Ponteiro para o grafo.
+ * @param minimo Número mínimo de antenas livres no novo bloco.
+ * @return false se não houve memória.
+ */
+bool novo_bloco_antenas(Grafo* grafo, int minimo) {
+    int capacidade = grafo->blocos_antenas ? grafo->blocos_antenas->capacidade * 2 : BLOCO_ANTENAS_MIN;
+    if (capacidade > BLOCO_ANTENAS_MAX) capacidade = BLOCO_ANTENAS_MAX;
+    if (capacidade < minimo) capacidade = minimo;
+
+    BlocoAntenas* bloco = (BlocoAntenas*)malloc(sizeof(BlocoAntenas) + (size_t)capacidade * sizeof(Antena));
+    if (!bloco) return false;
+    bloco->usadas = 0;
+    bloco->capacidade = capacidade;
+    bloco->prox = grafo->blocos_antenas;
+    grafo->blocos_antenas = bloco;
+    return true;
+}
 
 /**
  * @brief Cria um novo grafo vazio.
@@ -14,368 +179,3951 @@ Grafo* criar_grafo() {
     Grafo* grafo = (Grafo*)malloc(sizeof(Grafo));
     grafo->vertices = NULL;
     grafo->num_vertices = 0;
+    grafo->blocos_antenas = NULL;
+    grafo->linhas = 0;
+    grafo->colunas = 0;
+    grafo->indice = NULL;
+    grafo->capacidade_indice = 0;
+    grafo->frequencias = NULL;
+    grafo->xs = NULL;
+    grafo->ys = NULL;
+    grafo->tabela_coordenadas = NULL;
+    grafo->capacidade_coordenadas = 0;
+    grafo->num_coordenadas = 0;
+    grafo->seguinte_celula = NULL;
+    grafo->antenas_livres = NULL;
+    grafo->membros = NULL;
+    grafo->capacidade_membros = 0;
+    memset(grafo->membros_frequencia, 0, sizeof(grafo->membros_frequencia));
+    memset(grafo->tamanho_frequencia, 0, sizeof(grafo->tamanho_frequencia));
+    memset(grafo->capacidade_frequencia, 0, sizeof(grafo->capacidade_frequencia));
+    grafo->num_vertices_ligados = 0;
+    grafo->num_componentes = 0;
+    grafo->arestas_materializadas = false;
+    grafo->inicio_arestas = NULL;
+    grafo->destinos = NULL;
+    grafo->num_destinos = 0;
+    memset(grafo->arestas_frequencia, 0, sizeof(grafo->arestas_frequencia));
+    memset(grafo->largura_arestas, 0, sizeof(grafo->largura_arestas));
+    memset(grafo->linhas_arestas, 0, sizeof(grafo->linhas_arestas));
+    grafo->num_arestas = 0;
+    grafo->mapeamento.dados = NULL;
+    grafo->mapeamento.tamanho = 0;
+    grafo->mapeamento.mapeado = false;
+    memset(&grafo->grelha, 0, sizeof(grafo->grelha));
+#ifdef GRAFO_ESTATISTICAS
+    memset(&grafo->estatisticas, 0, sizeof(grafo->estatisticas));
+#endif
     return grafo;
 }
 
+/**
+ * @brief Indica se um vetor aponta para dentro do ficheiro binário mapeado.
+ * @param grafo Ponteiro para o grafo.
+ * @param vetor Vetor a testar.
+ * @return true se o vetor pertence ao mapeamento.
+ */
+bool vetor_mapeado(Grafo* grafo, const void* vetor) {
+    uintptr_t p = (uintptr_t)vetor;
+    uintptr_t inicio = (uintptr_t)grafo->mapeamento.dados;
+    return inicio && p >= inicio && p < inicio + grafo->mapeamento.tamanho;
+}
+
+/**
+ * @brief Liberta um vetor do grafo, exceto se apontar para o ficheiro mapeado.
+ *
+ * Um grafo carregado do formato binário usa diretamente os vetores do
+ * ficheiro; esses só são libertados com o próprio mapeamento.
+ * @param grafo Ponteiro para o grafo.
+ * @param vetor Vetor a libertar (pode ser NULL).
+ */
+void libertar_vetor(Grafo* grafo, const void* vetor) {
+    if (!vetor_mapeado(grafo, vetor)) free((void*)vetor);
+}
+
+/**
+ * @brief Liberta os buckets de frequência (o vetor @c membros e os blocos próprios).
+ * @param grafo Ponteiro para o grafo.
+ */
+void libertar_buckets(Grafo* grafo) {
+    for (int f = 0; f < 256; f++) {
+        if (grafo->capacidade_frequencia[f] > 0) free(grafo->membros_frequencia[f]);
+        grafo->membros_frequencia[f] = NULL;
+        grafo->tamanho_frequencia[f] = 0;
+        grafo->capacidade_frequencia[f] = 0;
+    }
+    libertar_vetor(grafo, grafo->membros);
+    grafo->membros = NULL;
+    grafo->capacidade_membros = 0;
+}
+
+/**
+ * @brief Liberta a CSR (os vetores gerados por conectar_antenas e os blocos próprios).
+ * @param grafo Ponteiro para o grafo.
+ */
+void libertar_csr(Grafo* grafo) {
+    for (int f = 0; f < 256; f++) {
+        if (grafo->largura_arestas[f] > 0) free(grafo->arestas_frequencia[f]);
+        grafo->arestas_frequencia[f] = NULL;
+        grafo->largura_arestas[f] = 0;
+        grafo->linhas_arestas[f] = 0;
+    }
+    libertar_vetor(grafo, grafo->inicio_arestas);
+    libertar_vetor(grafo, grafo->destinos);
+    grafo->inicio_arestas = NULL;
+    grafo->destinos = NULL;
+    grafo->num_destinos = 0;
+}
+
 /**
  * @brief Liberta toda a memória ocupada pelo grafo.
+ *
+ * As antenas vivem em blocos da arena, pelo que são libertadas bloco a
+ * bloco sem percorrer a lista de vértices.
  * @param grafo Ponteiro para o grafo a destruir.
  */
 void destruir_grafo(Grafo* grafo) {
-    Antena* atual = grafo->vertices;
-    while (atual) {
-        Antena* prox = atual->prox;
-        Aresta* aresta = atual->arestas;
-        while (aresta) {
-            Aresta* prox_aresta = aresta->prox;
-            free(aresta);
-            aresta = prox_aresta;
-        }
-        free(atual);
-        atual = prox;
+    BlocoAntenas* bloco = grafo->blocos_antenas;
+    while (bloco) {
+        BlocoAntenas* prox = bloco->prox;
+        free(bloco);
+        bloco = prox;
     }
+    free(grafo->indice);
+    libertar_vetor(grafo, grafo->frequencias);
+    libertar_vetor(grafo, grafo->xs);
+    libertar_vetor(grafo, grafo->ys);
+    libertar_vetor(grafo, grafo->tabela_coordenadas);
+    free(grafo->seguinte_celula);
+    libertar_buckets(grafo);
+    libertar_csr(grafo);
+    free(grafo->grelha.ocupacao);
+    free(grafo->grelha.frequencias);
+    desmapear_ficheiro(&grafo->mapeamento);
     free(grafo);
 }
 
 /**
- * @brief Adiciona uma antena ao grafo.
- * @param grafo Ponteiro para o grafo.
- * @param frequencia Frequência da antena.
+ * @brief Calcula a posição inicial de um par de coordenadas na tabela de hash.
  * @param x Coordenada X.
  * @param y Coordenada Y.
- * @return Ponteiro para a antena criada.
+ * @param mascara Capacidade da tabela menos um.
+ * @return Posição na tabela.
  */
-Antena* adicionar_antena(Grafo* grafo, char frequencia, int x, int y) {
-    Antena* nova = (Antena*)malloc(sizeof(Antena));
-    nova->frequencia = frequencia;
-    nova->x = x;
-    nova->y = y;
-    nova->visitado = false;
-    nova->arestas = NULL;
-    nova->prox = grafo->vertices;
-    grafo->vertices = nova;
-    grafo->num_vertices++;
-    return nova;
+int hash_coordenadas(int x, int y, int mascara) {
+    unsigned long long chave = ((unsigned long long)(unsigned int)x << 32) | (unsigned int)y;
+    chave ^= chave >> 33;
+    chave *= 0xff51afd7ed558ccdULL;
+    chave ^= chave >> 33;
+    return (int)(chave & (unsigned long long)mascara);
 }
 
 /**
- * @brief Conecta automaticamente antenas com a mesma frequência.
- * @param grafo Ponteiro para o grafo.
+ * @brief Insere uma antena na tabela de coordenadas.
+ *
+ * Se já existir uma antena nas mesmas coordenadas, a nova passa a ser a
+ * devolvida por encontrar_antena, tal como acontecia com a pesquisa linear,
+ * e as anteriores ficam na sua cadeia. A antena tem de ter um id maior do
+ * que as já indexadas na mesma célula.
+ * @param grafo Ponteiro para o grafo (com capacidade suficiente).
+ * @param antena Antena a indexar.
  */
-void conectar_antenas(Grafo* grafo) {
-    Antena* atual = grafo->vertices;
-    while (atual) {
-        Antena* outra = grafo->vertices;
-        while (outra) {
-            if (atual != outra && atual->frequencia == outra->frequencia) {
-                bool conectado = false;
-                Aresta* aresta = atual->arestas;
-                while (aresta) {
-                    if (aresta->destino == outra) {
-                        conectado = true;
-                        break;
-                    }
-                    aresta = aresta->prox;
-                }
-                if (!conectado) {
-                    Aresta* nova_aresta = (Aresta*)malloc(sizeof(Aresta));
-                    nova_aresta->destino = outra;
-                    nova_aresta->prox = atual->arestas;
-                    atual->arestas = nova_aresta;
-                }
-            }
-            outra = outra->prox;
-        }
-        atual = atual->prox;
+void indexar_coordenadas(Grafo* grafo, Antena* antena) {
+    int mascara = grafo->capacidade_coordenadas - 1;
+    int pos = hash_coordenadas(antena->x, antena->y, mascara);
+    while (grafo->tabela_coordenadas[pos] >= 0) {
+        int ocupante = grafo->tabela_coordenadas[pos];
+        if (grafo->xs[ocupante] == antena->x && grafo->ys[ocupante] == antena->y) break;
+        pos = (pos + 1) & mascara;
     }
+    ESTATISTICA_SOMAR(grafo, sondagens_coordenadas, ((pos - hash_coordenadas(antena->x, antena->y, mascara)) & mascara) + 1);
+    int ocupante = grafo->tabela_coordenadas[pos];
+    if (ocupante < 0) grafo->num_coordenadas++;
+    grafo->seguinte_celula[antena->id] = ocupante;
+    grafo->tabela_coordenadas[pos] = antena->id;
 }
 
 /**
- * @brief Função auxiliar recursiva para DFS.
- * @param antena Antena atual.
- * @param callback Função chamada em cada visita.
+ * @brief Procura a posição da tabela de coordenadas de uma célula.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Posição na tabela, ou -1 se não há antenas na célula.
  */
-void dfs_util(Antena* antena, void (*callback)(Antena*)) {
-    if (!antena || antena->visitado) return;
-    antena->visitado = true;
-    callback(antena);
-    Aresta* aresta = antena->arestas;
-    while (aresta) {
-        dfs_util(aresta->destino, callback);
-        aresta = aresta->prox;
+int posicao_celula(Grafo* grafo, int x, int y) {
+    int mascara = grafo->capacidade_coordenadas - 1;
+    int pos = hash_coordenadas(x, y, mascara);
+    while (grafo->tabela_coordenadas[pos] >= 0) {
+        int ocupante = grafo->tabela_coordenadas[pos];
+        if (grafo->xs[ocupante] == x && grafo->ys[ocupante] == y) return pos;
+        pos = (pos + 1) & mascara;
     }
+    return -1;
 }
 
 /**
- * @brief Executa busca em profundidade (DFS).
+ * @brief Apaga uma posição da tabela de coordenadas (backward-shift).
+ *
+ * As entradas seguintes do mesmo cluster são recuadas quando a posição
+ * libertada fica entre a sua posição ideal e a atual, para que a sondagem
+ * linear continue a encontrá-las sem recorrer a lápides.
  * @param grafo Ponteiro para o grafo.
- * @param inicio Antena inicial.
- * @param callback Função chamada em cada antena visitada.
+ * @param pos Posição ocupada a apagar.
  */
-void dfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*)) {
-    reiniciar_visitas(grafo);
-    dfs_util(inicio, callback);
+void apagar_coordenadas(Grafo* grafo, int pos) {
+    int mascara = grafo->capacidade_coordenadas - 1;
+    int* tabela = grafo->tabela_coordenadas;
+    for (int j = (pos + 1) & mascara; tabela[j] >= 0; j = (j + 1) & mascara) {
+        int ideal = hash_coordenadas(grafo->xs[tabela[j]], grafo->ys[tabela[j]], mascara);
+        if (((j - ideal) & mascara) >= ((j - pos) & mascara)) {
+            tabela[pos] = tabela[j];
+            pos = j;
+        }
+    }
+    tabela[pos] = -1;
+    grafo->num_coordenadas--;
 }
 
 /**
- * @brief Executa busca em largura (BFS).
+ * @brief Redimensiona um vetor do grafo.
+ *
+ * Um vetor que aponta para o ficheiro mapeado não pode ser passado a
+ * realloc: é copiado para um bloco novo.
  * @param grafo Ponteiro para o grafo.
- * @param inicio Antena inicial.
- * @param callback Função chamada em cada antena visitada.
+ * @param vetor Vetor atual (pode ser NULL).
+ * @param usado Bytes de @p vetor a preservar.
+ * @param tamanho Novo tamanho em bytes.
+ * @return Vetor redimensionado, ou NULL sem memória (@p vetor fica intacto).
  */
-void bfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*)) {
-    reiniciar_visitas(grafo);
-    Antena** fila = (Antena**)malloc(grafo->num_vertices * sizeof(Antena*));
-    int inicio_fila = 0, fim_fila = 0;
-    fila[fim_fila++] = inicio;
-    inicio->visitado = true;
+void* crescer_vetor(Grafo* grafo, void* vetor, size_t usado, size_t tamanho) {
+    if (!vetor_mapeado(grafo, vetor)) return realloc(vetor, tamanho);
+    void* novo = malloc(tamanho);
+    if (novo && usado > 0) memcpy(novo, vetor, usado);
+    return novo;
+}
 
-    while (inicio_fila < fim_fila) {
-        Antena* atual = fila[inicio_fila++];
-        callback(atual);
+/**
+ * @brief Reserva espaço para um dado número total de antenas.
+ * @param grafo Ponteiro para o grafo.
+ * @param total Número total de antenas esperado.
+ * @return false se não houve memória.
+ */
+bool reservar_antenas(Grafo* grafo, int total) {
+    int em_falta = total - grafo->num_vertices;
+    BlocoAntenas* bloco = grafo->blocos_antenas;
+    int livres = bloco ? bloco->capacidade - bloco->usadas : 0;
+    if (em_falta > livres && !novo_bloco_antenas(grafo, em_falta)) return false;
 
-        Aresta* aresta = atual->arestas;
-        while (aresta) {
-            if (!aresta->destino->visitado) {
-                fila[fim_fila++] = aresta->destino;
-                aresta->destino->visitado = true;
-            }
-            aresta = aresta->prox;
+    if (total > grafo->capacidade_indice) {
+        int capacidade = grafo->capacidade_indice ? grafo->capacidade_indice * 2 : 64;
+        if (capacidade < total) capacidade = total;
+        size_t n = (size_t)grafo->num_vertices;
+        Antena** indice = (Antena**)realloc(grafo->indice, capacidade * sizeof(Antena*));
+        if (!indice) return false;
+        grafo->indice = indice;
+        char* frequencias = (char*)crescer_vetor(grafo, grafo->frequencias, n, (size_t)capacidade);
+        if (!frequencias) return false;
+        grafo->frequencias = frequencias;
+        int* xs = (int*)crescer_vetor(grafo, grafo->xs, n * sizeof(int), capacidade * sizeof(int));
+        if (!xs) return false;
+        grafo->xs = xs;
+        int* ys = (int*)crescer_vetor(grafo, grafo->ys, n * sizeof(int), capacidade * sizeof(int));
+        if (!ys) return false;
+        grafo->ys = ys;
+        int* seguinte = (int*)realloc(grafo->seguinte_celula, capacidade * sizeof(int));
+        if (!seguinte) return false;
+        grafo->seguinte_celula = seguinte;
+        if (grafo->inicio_arestas) {
+            int* inicio = (int*)crescer_vetor(grafo, grafo->inicio_arestas, n * sizeof(int), capacidade * sizeof(int));
+            if (!inicio) return false;
+            grafo->inicio_arestas = inicio;
         }
+        grafo->capacidade_indice = capacidade;
     }
 
-    free(fila);
+    // A tabela de coordenadas é mantida abaixo de 50% de ocupação.
+    if ((long long)total * 2 <= grafo->capacidade_coordenadas) return true;
+    int capacidade = grafo->capacidade_coordenadas ? grafo->capacidade_coordenadas : 128;
+    while ((long long)capacidade < (long long)total * 2) capacidade *= 2;
+    int* tabela = (int*)malloc(capacidade * sizeof(int));
+    if (!tabela) return false;
+    memset(tabela, -1, capacidade * sizeof(int));
+
+    libertar_vetor(grafo, grafo->tabela_coordenadas);
+    grafo->tabela_coordenadas = tabela;
+    grafo->capacidade_coordenadas = capacidade;
+    grafo->num_coordenadas = 0;
+    for (int i = 0; i < grafo->num_vertices; i++) {
+        indexar_coordenadas(grafo, grafo->indice[i]);
+    }
+    return true;
 }
 
 /**
- * @brief Função auxiliar para encontrar caminhos entre antenas.
+ * @brief Obtém o nó de uma antena e regista-o na lista e no índice por id.
+ *
+ * O nó é reaproveitado de uma antena removida ou obtido da arena do grafo
+ * (incremento de um contador no bloco atual). Não escreve nos vetores de
+ * atributos: serve a carregar_grafo_binario, cujos vetores já vêm do ficheiro.
+ * @param grafo Ponteiro para o grafo (com capacidade no índice).
+ * @param frequencia Frequência da antena.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Ponteiro para a antena criada, ou NULL sem memória.
  */
-void encontrar_caminhos_util(Antena* atual, Antena* destino, Antena** caminho, int* index, void (*callback)(Antena**, int)) {
-    caminho[(*index)++] = atual;
-    atual->visitado = true;
-
-    if (atual == destino) {
-        callback(caminho, *index);
+Antena* alocar_no_antena(Grafo* grafo, char frequencia, int x, int y) {
+    Antena* nova = grafo->antenas_livres;
+    if (nova) {
+        grafo->antenas_livres = nova->prox;
     } else {
-        Aresta* aresta = atual->arestas;
-        while (aresta) {
-            if (!aresta->destino->visitado) {
-                encontrar_caminhos_util(aresta->destino, destino, caminho, index, callback);
-            }
-            aresta = aresta->prox;
+        BlocoAntenas* bloco = grafo->blocos_antenas;
+        if (!bloco || bloco->usadas == bloco->capacidade) {
+            if (!novo_bloco_antenas(grafo, 1)) return NULL;
+            bloco = grafo->blocos_antenas;
         }
+        nova = &bloco->antenas[bloco->usadas++];
     }
-
-    (*index)--;
-    atual->visitado = false;
+    nova->frequencia = frequencia;
+    nova->x = x;
+    nova->y = y;
+    nova->id = grafo->num_vertices;
+    nova->prox = grafo->vertices;
+    grafo->vertices = nova;
+    grafo->indice[nova->id] = nova;
+    grafo->num_vertices++;
+    return nova;
 }
 
 /**
- * @brief Encontra todos os caminhos entre duas antenas.
+ * @brief Cria o nó de uma antena e preenche os seus atributos por id.
+ *
+ * Não atualiza a tabela de coordenadas nem as dimensões da grelha.
+ * @param grafo Ponteiro para o grafo (com capacidade no índice).
+ * @param frequencia Frequência da antena.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Ponteiro para a antena criada, ou NULL sem memória.
  */
-void encontrar_caminhos(Grafo* grafo, Antena* origem, Antena* destino, void (*callback)(Antena**, int)) {
-    reiniciar_visitas(grafo);
-    Antena** caminho = (Antena**)malloc(grafo->num_vertices * sizeof(Antena*));
-    int index = 0;
-    encontrar_caminhos_util(origem, destino, caminho, &index, callback);
-    free(caminho);
+Antena* criar_no_antena(Grafo* grafo, char frequencia, int x, int y) {
+    Antena* nova = alocar_no_antena(grafo, frequencia, x, y);
+    if (!nova) return NULL;
+    grafo->frequencias[nova->id] = frequencia;
+    grafo->xs[nova->id] = x;
+    grafo->ys[nova->id] = y;
+    return nova;
 }
 
+#define GRELHA_MAX_CELULAS ((size_t)1 << 30) /**< Limite de células da grelha densa (1 GiB de frequências). */
+
 /**
- * @brief Lista interseções entre antenas de diferentes frequências.
+ * @brief Garante que a grelha densa cobre pelo menos @p linhas x @p colunas células.
+ *
+ * A grelha cresce geometricamente; as colunas são arredondadas a um
+ * múltiplo de 64 para cada linha do bitmap ocupar palavras inteiras. Os
+ * tamanhos são calculados em size_t e limitados a GRELHA_MAX_CELULAS.
+ * @param grafo Ponteiro para o grafo (com a grelha ativa).
+ * @param linhas Número mínimo de linhas.
+ * @param colunas Número mínimo de colunas.
+ * @return false se não houve memória ou se o limite seria excedido (a grelha fica como estava).
  */
-void listar_intersecoes(Grafo* grafo, char freqA, char freqB, void (*callback)(Antena*, Antena*)) {
-    Antena* a = grafo->vertices;
-    while (a) {
-        if (a->frequencia == freqA) {
-            Antena* b = grafo->vertices;
-            while (b) {
-                if (b->frequencia == freqB) {
-                    if ((a->x == b->x || a->y == b->y) || (abs(a->x - b->x) == abs(a->y - b->y))) {
-                        double distA = sqrt(a->x*a->x + a->y*a->y);
-                        double distB = sqrt(b->x*b->x + b->y*b->y);
-                        if (fabs(distA - 2*distB) < 1e-6 || fabs(distB - 2*distA) < 1e-6) {
-                            callback(a, b);
-                        }
-                    }
-                }
-                b = b->prox;
-            }
-        }
-        a = a->prox;
+bool garantir_grelha(Grafo* grafo, size_t linhas, size_t colunas) {
+    GrelhaDensa* g = &grafo->grelha;
+    size_t novas_linhas = (size_t)g->linhas, novas_colunas = (size_t)g->colunas;
+    if (linhas <= novas_linhas && colunas <= novas_colunas) return true;
+    if (linhas > GRELHA_MAX_CELULAS || colunas > GRELHA_MAX_CELULAS) return false;
+
+    if (linhas > novas_linhas) novas_linhas = linhas > novas_linhas * 2 ? linhas : novas_linhas * 2;
+    if (colunas > novas_colunas) novas_colunas = colunas > novas_colunas * 2 ? colunas : novas_colunas * 2;
+    novas_colunas = (novas_colunas + 63) & ~(size_t)63;
+    if (novas_linhas < 1) novas_linhas = 1;
+    if (novas_colunas < 64) novas_colunas = 64;
+    if (novas_linhas > GRELHA_MAX_CELULAS / novas_colunas) {
+        // Sem margem para o crescimento geométrico, tenta só o tamanho pedido.
+        novas_linhas = linhas > (size_t)g->linhas ? linhas : (size_t)g->linhas;
+        novas_colunas = colunas > (size_t)g->colunas ? colunas : (size_t)g->colunas;
+        novas_colunas = (novas_colunas + 63) & ~(size_t)63;
+        if (novas_linhas < 1) novas_linhas = 1;
+        if (novas_linhas > GRELHA_MAX_CELULAS / novas_colunas) return false;
     }
+    size_t palavras = novas_colunas / 64;
+
+    uint64_t* ocupacao = (uint64_t*)calloc(novas_linhas * palavras, sizeof(uint64_t));
+    unsigned char* frequencias = (unsigned char*)calloc(novas_linhas * novas_colunas, 1);
+    if (!ocupacao || !frequencias) {
+        free(ocupacao);
+        free(frequencias);
+        return false;
+    }
+    for (int y = 0; y < g->linhas; y++) {
+        memcpy(ocupacao + (size_t)y * palavras, g->ocupacao + (size_t)y * g->palavras_linha,
+               (size_t)g->palavras_linha * sizeof(uint64_t));
+        memcpy(frequencias + (size_t)y * novas_colunas, g->frequencias + (size_t)y * g->colunas, (size_t)g->colunas);
+    }
+    free(g->ocupacao);
+    free(g->frequencias);
+    g->ocupacao = ocupacao;
+    g->frequencias = frequencias;
+    g->linhas = (int)novas_linhas;
+    g->colunas = (int)novas_colunas;
+    g->palavras_linha = (int)palavras;
+    return true;
 }
 
 /**
- * @brief Carrega o grafo de um ficheiro de texto.
+ * @brief Marca a célula de uma antena na grelha densa, se ainda estiver livre.
+ * @param grafo Ponteiro para o grafo (com a grelha a cobrir a antena).
+ * @param antena Antena a marcar.
  */
-Grafo* carregar_grafo_arquivo(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) return NULL;
+void marcar_celula(Grafo* grafo, Antena* antena) {
+    GrelhaDensa* g = &grafo->grelha;
+    if (antena->x < 0 || antena->y < 0) return;
+    uint64_t* palavra = &g->ocupacao[(size_t)antena->y * g->palavras_linha + (antena->x >> 6)];
+    uint64_t bit = 1ULL << (antena->x & 63);
+    if (*palavra & bit) return;
+    *palavra |= bit;
+    g->frequencias[(size_t)antena->y * g->colunas + antena->x] = (unsigned char)antena->frequencia;
+}
 
-    Grafo* grafo = criar_grafo();
-    char linha[1024];
-    int y = 0;
+/**
+ * @brief Ativa ou desativa a grelha densa.
+ *
+ * As antenas são marcadas por ordem de id, para que numa célula partilhada
+ * fique a mais antiga, como na impressão da matriz.
+ */
+bool definir_grelha_densa(Grafo* grafo, bool ativar) {
+    GrelhaDensa* g = &grafo->grelha;
+    free(g->ocupacao);
+    free(g->frequencias);
+    memset(g, 0, sizeof(*g));
+    if (!ativar) return true;
 
-    while (fgets(linha, sizeof(linha), file)) {
-        for (int x = 0; linha[x] != '\0' && linha[x] != '\n'; x++) {
-            if (linha[x] != '.') {
-                adicionar_antena(grafo, linha[x], x, y);
-            }
-        }
-        y++;
+    if (!garantir_grelha(grafo, (size_t)grafo->linhas, (size_t)grafo->colunas)) return false;
+    for (int i = 0; i < grafo->num_vertices; i++) {
+        marcar_celula(grafo, grafo->indice[i]);
     }
+    return true;
+}
 
-    fclose(file);
-    conectar_antenas(grafo);
-    return grafo;
+/**
+ * @brief Adiciona uma antena ao grafo.
+ *
+ * Se a grelha densa não puder crescer até à nova antena, é desativada e as
+ * pesquisas passam a usar só a tabela de coordenadas.
+ * @param grafo Ponteiro para o grafo.
+ * @param frequencia Frequência da antena.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Ponteiro para a antena criada.
+ */
+Antena* adicionar_antena(Grafo* grafo, char frequencia, int x, int y) {
+    if (!reservar_antenas(grafo, grafo->num_vertices + 1)) return NULL;
+    if (grafo->grelha.frequencias && x >= 0 && y >= 0 && !garantir_grelha(grafo, (size_t)y + 1, (size_t)x + 1)) {
+        definir_grelha_densa(grafo, false);
+    }
+
+    Antena* nova = criar_no_antena(grafo, frequencia, x, y);
+    if (!nova) return NULL;
+    indexar_coordenadas(grafo, nova);
+    if (grafo->grelha.frequencias) marcar_celula(grafo, nova);
+    if (x >= grafo->colunas) grafo->colunas = x < INT_MAX ? x + 1 : INT_MAX;
+    if (y >= grafo->linhas) grafo->linhas = y < INT_MAX ? y + 1 : INT_MAX;
+    return nova;
 }
 
 /**
- * @brief Gera uma matriz de caracteres representando as antenas.
+ * @brief Materializa as cliques de frequência numa adjacência CSR.
+ *
+ * As linhas ficam todas em @c destinos, por ordem de id; cada antena tem
+ * exatamente o espaço dos vizinhos que tem agora.
+ * @param grafo Ponteiro para o grafo já agrupado em buckets.
+ * @return false se não houve memória.
  */
-void gerar_matriz(Grafo* grafo, int linhas, int colunas, char*** matriz) {
-    *matriz = (char**)malloc(linhas * sizeof(char*));
-    for (int i = 0; i < linhas; i++) {
-        (*matriz)[i] = (char*)malloc(colunas * sizeof(char));
-        for (int j = 0; j < colunas; j++) {
-            (*matriz)[i][j] = '.';
+bool construir_csr(Grafo* grafo) {
+    int n = grafo->num_vertices_ligados;
+    int capacidade = grafo->capacidade_indice > n ? grafo->capacidade_indice : n;
+    int* inicio = (int*)malloc((capacidade > 0 ? capacidade : 1) * sizeof(int));
+    if (!inicio) return false;
+    long long total = 0;
+    for (int i = 0; i < n; i++) {
+        inicio[i] = (int)total;
+        total += grafo->tamanho_frequencia[(unsigned char)grafo->frequencias[i]] - 1;
+        if (total > INT_MAX) {
+            free(inicio);
+            return false;
         }
     }
 
-    Antena* atual = grafo->vertices;
-    while (atual) {
-        if (atual->y < linhas && atual->x < colunas) {
-            (*matriz)[atual->y][atual->x] = atual->frequencia;
+    int* destinos = (int*)malloc((total > 0 ? total : 1) * sizeof(int));
+    if (!destinos) {
+        free(inicio);
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        unsigned char f = (unsigned char)grafo->frequencias[i];
+        const int* bucket = grafo->membros_frequencia[f];
+        int* linha = destinos + inicio[i];
+        for (int k = 0; k < grafo->tamanho_frequencia[f]; k++) {
+            if (bucket[k] != i) *linha++ = bucket[k];
         }
-        atual = atual->prox;
     }
+
+    libertar_csr(grafo);
+    grafo->inicio_arestas = inicio;
+    grafo->destinos = destinos;
+    grafo->num_destinos = total;
+    for (int f = 0; f < 256; f++) grafo->arestas_frequencia[f] = destinos;
+    return true;
 }
 
 /**
- * @brief Liberta a memória de uma matriz.
+ * @brief Atribui um id de componente conexa a cada classe de frequência.
+ *
+ * Todas as ligações são entre antenas da mesma frequência e cada frequência
+ * é uma clique, pelo que as componentes conexas são exatamente os buckets
+ * não vazios: basta uma passagem pelas 256 frequências.
+ * @param grafo Ponteiro para o grafo já agrupado em buckets.
  */
-void liberar_matriz(char** matriz, int linhas) {
-    for (int i = 0; i < linhas; i++) {
-        free(matriz[i]);
+void rotular_componentes(Grafo* grafo) {
+    grafo->num_componentes = 0;
+    for (int f = 0; f < 256; f++) {
+        if (grafo->tamanho_frequencia[f] > 0) {
+            grafo->componente_frequencia[f] = grafo->num_componentes;
+            grafo->frequencia_componente[grafo->num_componentes] = (unsigned char)f;
+            grafo->num_componentes++;
+        } else {
+            grafo->componente_frequencia[f] = -1;
+        }
     }
-    free(matriz);
 }
 
 /**
- * @brief Imprime a matriz no formato de texto.
+ * @brief Conecta automaticamente antenas com a mesma frequência.
+ *
+ * Agrupa as antenas por frequência com uma contagem (counting sort estável),
+ * em tempo e memória O(V). Cada bucket representa uma clique implícita; a
+ * CSR com as arestas explícitas só é gerada se tiver sido pedida.
+ * @param grafo Ponteiro para o grafo.
  */
-void imprimir_matriz(Grafo* grafo, int linhas, int colunas) {
-    char** matriz = NULL;
-    gerar_matriz(grafo, linhas, colunas, &matriz);
-    if (!matriz) return;
+void conectar_antenas(Grafo* grafo) {
+    ESTATISTICA_INICIO(inicio);
+    int n = grafo->num_vertices;
+    int* membros = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    if (!membros) return;
 
-    for (int i = 0; i < linhas; i++) {
-        for (int j = 0; j < colunas; j++) {
-            printf("%c", matriz[i][j]);
-        }
-        printf("\n");
+    int contagem[256] = {0};
+    for (int i = 0; i < n; i++) {
+        contagem[(unsigned char)grafo->frequencias[i]]++;
+    }
+
+    libertar_buckets(grafo);
+    long long num_arestas = 0;
+    int deslocamento = 0;
+    for (int f = 0; f < 256; f++) {
+        grafo->membros_frequencia[f] = membros + deslocamento;
+        deslocamento += contagem[f];
+        num_arestas += (long long)contagem[f] * (contagem[f] > 0 ? contagem[f] - 1 : 0);
     }
 
-    liberar_matriz(matriz, linhas);
+    for (int i = 0; i < n; i++) {
+        unsigned char f = (unsigned char)grafo->frequencias[i];
+        grafo->membros_frequencia[f][grafo->tamanho_frequencia[f]++] = i;
+    }
+
+    grafo->membros = membros;
+    grafo->capacidade_membros = n > 0 ? n : 1;
+    grafo->num_vertices_ligados = n;
+    grafo->num_arestas = num_arestas;
+    rotular_componentes(grafo);
+
+    libertar_csr(grafo);
+    if (grafo->arestas_materializadas) construir_csr(grafo);
+    ESTATISTICA_SOMAR(grafo, arestas_criadas, num_arestas);
+    ESTATISTICA_FIM(grafo, conectar, inicio);
 }
 
 /**
- * @brief Encontra uma antena pelas suas coordenadas.
+ * @brief Ativa ou desativa a materialização explícita das arestas.
+ * @param grafo Ponteiro para o grafo.
+ * @param materializar true para materializar as arestas.
+ * @return false se não houve memória para construir a CSR.
  */
-Antena* encontrar_antena(Grafo* grafo, int x, int y) {
-    Antena* atual = grafo->vertices;
-    while (atual) {
-        if (atual->x == x && atual->y == y) {
-            return atual;
-        }
-        atual = atual->prox;
+bool definir_arestas_materializadas(Grafo* grafo, bool materializar) {
+    grafo->arestas_materializadas = materializar;
+    if (!grafo->membros) return true;
+
+    if (materializar) {
+        return grafo->inicio_arestas || construir_csr(grafo);
     }
-    return NULL;
+    libertar_csr(grafo);
+    return true;
 }
 
 /**
- * @brief Reinicia a marcação de "visitado" das antenas.
+ * @brief Procura, por pesquisa binária, a posição de um id num bucket.
+ * @param bucket Ids do bucket, por ordem crescente.
+ * @param tamanho Número de ids a considerar.
+ * @param id Id procurado.
+ * @return Primeira posição com um id >= @p id.
  */
-void reiniciar_visitas(Grafo* grafo) {
-    Antena* atual = grafo->vertices;
-    while (atual) {
-        atual->visitado = false;
-        atual = atual->prox;
+int posicao_no_bucket(const int* bucket, int tamanho, int id) {
+    int inicio = 0, fim = tamanho;
+    while (inicio < fim) {
+        int meio = inicio + (fim - inicio) / 2;
+        if (bucket[meio] < id) inicio = meio + 1;
+        else fim = meio;
     }
+    return inicio;
 }
 
 /**
- * @brief Guarda o grafo num ficheiro binário.
+ * @brief Garante espaço no bucket de uma frequência para um dado número de ids.
+ *
+ * Um bucket que ainda está em @c membros (ou no ficheiro mapeado) passa
+ * para um bloco próprio; um bloco próprio cresce para o dobro. Só o bucket
+ * @p f é copiado.
+ * @param grafo Ponteiro para o grafo.
+ * @param f Frequência.
+ * @param total Número de ids necessário.
+ * @return false se não houve memória (o bucket fica como estava).
  */
-bool salvar_grafo_binario(Grafo* grafo, const char* filename) {
-    FILE* file = fopen(filename, "wb");
-    if (!file) return false;
+bool reservar_bucket(Grafo* grafo, unsigned char f, int total) {
+    if (total <= grafo->capacidade_frequencia[f]) return true;
+    int capacidade = grafo->capacidade_frequencia[f] * 2;
+    if (capacidade < 16) capacidade = 16;
+    if (capacidade < total) capacidade = total;
+    int* bucket = (int*)malloc(capacidade * sizeof(int));
+    if (!bucket) return false;
+    if (grafo->tamanho_frequencia[f] > 0) {
+        memcpy(bucket, grafo->membros_frequencia[f], (size_t)grafo->tamanho_frequencia[f] * sizeof(int));
+    }
+    if (grafo->capacidade_frequencia[f] > 0) free(grafo->membros_frequencia[f]);
+    grafo->membros_frequencia[f] = bucket;
+    grafo->capacidade_frequencia[f] = capacidade;
+    return true;
+}
 
-    fwrite(&grafo->num_vertices, sizeof(int), 1, file);
-    Antena* atual = grafo->vertices;
-    while (atual) {
-        fwrite(&atual->frequencia, sizeof(char), 1, file);
-        fwrite(&atual->x, sizeof(int), 1, file);
-        fwrite(&atual->y, sizeof(int), 1, file);
-        atual = atual->prox;
+/**
+ * @brief Reescreve no sítio as linhas CSR das antenas de uma frequência.
+ *
+ * Cada linha passa a ser o bucket sem a própria antena. Num bloco próprio a
+ * linha de cada membro é a da sua posição no bucket; em @c destinos cada
+ * antena mantém a sua linha, que nunca tem menos espaço do que os vizinhos
+ * atuais (uma frequência que cresce passa para um bloco próprio).
+ * @param grafo Ponteiro para o grafo.
+ * @param f Frequência.
+ */
+void reescrever_linhas(Grafo* grafo, unsigned char f) {
+    int k = grafo->tamanho_frequencia[f];
+    int largura = grafo->largura_arestas[f];
+    const int* membros = grafo->membros_frequencia[f];
+    for (int r = 0; r < k; r++) {
+        if (largura > 0) grafo->inicio_arestas[membros[r]] = r * largura;
+        if (k == 1) break;
+        int* linha = grafo->arestas_frequencia[f] + grafo->inicio_arestas[membros[r]];
+        memcpy(linha, membros, (size_t)r * sizeof(int));
+        memcpy(linha + r, membros + r + 1, (size_t)(k - r - 1) * sizeof(int));
     }
+}
 
-    fclose(file);
-    return true;
+/**
+ * @brief Indica se as linhas CSR de uma frequência cabem no bloco atual.
+ * @param grafo Ponteiro para o grafo.
+ * @param f Frequência.
+ * @param k Número de antenas da frequência.
+ * @return true se não é preciso um bloco novo.
+ */
+bool linhas_com_espaco(Grafo* grafo, unsigned char f, int k) {
+    return k <= 1 || (grafo->largura_arestas[f] >= k - 1 && grafo->linhas_arestas[f] >= k);
 }
 
 /**
- * @brief Carrega o grafo de um ficheiro binário.
+ * @brief Reserva um bloco próprio para as linhas CSR de uma frequência.
+ *
+ * O bloco tem folga de metade do tamanho em linhas e em largura, para que
+ * as inserções seguintes só acrescentem uma entrada a cada linha; o custo
+ * O(k²) de passar para um bloco novo fica amortizado por O(k) inserções.
+ * @param k Número de antenas da frequência.
+ * @param bloco Recebe o bloco.
+ * @param largura Recebe o número de posições por linha.
+ * @param linhas Recebe o número de linhas.
+ * @return false se não houve memória ou os offsets não cabem num int.
  */
-Grafo* carregar_grafo_binario(const char* filename) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) return NULL;
+bool novo_bloco_linhas(int k, int** bloco, int* largura, int* linhas) {
+    long long total = (long long)k + k / 2 + 4;
+    if (total * (total - 1) > INT_MAX) return false;
+    *bloco = (int*)malloc((size_t)(total * (total - 1)) * sizeof(int));
+    *linhas = (int)total;
+    *largura = (int)total - 1;
+    return *bloco != NULL;
+}
 
-    Grafo* grafo = criar_grafo();
-    int num_vertices;
-    if (fread(&num_vertices, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        destruir_grafo(grafo);
-        return NULL;
+/**
+ * @brief Acrescenta às linhas CSR a antena que acabou de entrar no bucket @p f.
+ *
+ * Com um bloco novo as linhas da frequência são lá reescritas e o bloco
+ * anterior é libertado. Caso contrário o bloco atual tem espaço: o novo id
+ * vai para o fim de cada linha e a linha da nova antena é uma cópia do
+ * bucket, em O(k).
+ * @param grafo Ponteiro para o grafo.
+ * @param f Frequência.
+ * @param bloco Bloco novo (de novo_bloco_linhas), ou NULL.
+ * @param largura Posições por linha do bloco novo.
+ * @param linhas Linhas do bloco novo.
+ */
+void acrescentar_linhas(Grafo* grafo, unsigned char f, int* bloco, int largura, int linhas) {
+    int k = grafo->tamanho_frequencia[f] - 1;
+    const int* membros = grafo->membros_frequencia[f];
+    int nova = membros[k];
+    if (bloco) {
+        if (grafo->largura_arestas[f] > 0) free(grafo->arestas_frequencia[f]);
+        grafo->arestas_frequencia[f] = bloco;
+        grafo->largura_arestas[f] = largura;
+        grafo->linhas_arestas[f] = linhas;
+        reescrever_linhas(grafo, f);
+        return;
     }
+    if (k == 0) {
+        grafo->inicio_arestas[nova] = 0;
+        return;
+    }
+    int* base = grafo->arestas_frequencia[f];
+    largura = grafo->largura_arestas[f];
+    for (int r = 0; r < k; r++) base[(size_t)r * largura + k - 1] = nova;
+    memcpy(base + (size_t)k * largura, membros, (size_t)k * sizeof(int));
+    grafo->inicio_arestas[nova] = k * largura;
+}
 
-    for (int i = 0; i < num_vertices; i++) {
-        char freq;
-        int x, y;
-        if (fread(&freq, sizeof(char), 1, file) != 1 ||
-            fread(&x, sizeof(int), 1, file) != 1 ||
-            fread(&y, sizeof(int), 1, file) != 1) {
-            fclose(file);
-            destruir_grafo(grafo);
-            return NULL;
-        }
-        adicionar_antena(grafo, freq, x, y);
+/**
+ * @brief Adiciona uma antena e liga-a apenas ao bucket da sua frequência.
+ *
+ * Como a nova antena tem o maior id, fica no fim do bucket, que tem folga
+ * própria: os restantes buckets não são tocados. O espaço no bucket e nas
+ * linhas CSR é reservado antes de adicionar a antena, para que uma falha
+ * deixe o grafo como estava.
+ */
+Antena* inserir_antena(Grafo* grafo, char frequencia, int x, int y) {
+    if (!grafo->membros || grafo->num_vertices_ligados != grafo->num_vertices) {
+        Antena* nova = adicionar_antena(grafo, frequencia, x, y);
+        if (nova) conectar_antenas(grafo);
+        return nova;
+    }
+    unsigned char f = (unsigned char)frequencia;
+    int tamanho = grafo->tamanho_frequencia[f];
+    int* bloco = NULL;
+    int largura = 0, linhas = 0;
+    if (!reservar_antenas(grafo, grafo->num_vertices + 1) || !reservar_bucket(grafo, f, tamanho + 1)) return NULL;
+    if (grafo->inicio_arestas && !linhas_com_espaco(grafo, f, tamanho + 1) &&
+        !novo_bloco_linhas(tamanho + 1, &bloco, &largura, &linhas)) {
+        return NULL;
+    }
+    Antena* nova = adicionar_antena(grafo, frequencia, x, y);
+    if (!nova) {
+        free(bloco);
+        return NULL;
     }
 
-    fclose(file);
-    conectar_antenas(grafo);
-    return grafo;
+    grafo->membros_frequencia[f][tamanho] = nova->id;
+    grafo->tamanho_frequencia[f] = tamanho + 1;
+    grafo->num_vertices_ligados = grafo->num_vertices;
+    grafo->num_arestas += 2LL * tamanho;
+    if (tamanho == 0) rotular_componentes(grafo);
+    if (grafo->inicio_arestas) acrescentar_linhas(grafo, f, bloco, largura, linhas);
+    return nova;
 }
 
 /**
- * @brief Imprime a matriz no formato binário (em bits).
+ * @brief Mostra na grelha densa uma antena numa célula, ou deixa-a livre.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @param id Id da antena a mostrar (a mais antiga da célula), ou -1.
  */
-void imprimir_matriz_em_binario(Grafo* grafo, int linhas, int colunas) {
-    char** matriz = NULL;
-    gerar_matriz(grafo, linhas, colunas, &matriz);
-    if (!matriz) return;
-
-    for (int i = 0; i < linhas; i++) {
-        for (int j = 0; j < colunas; j++) {
-            unsigned char c = matriz[i][j];
-            for (int b = 7; b >= 0; b--) {
-                printf("%d", (c >> b) & 1);
-            }
-            printf(" ");
-        }
-        printf("\n");
+void atualizar_celula(Grafo* grafo, int x, int y, int id) {
+    GrelhaDensa* g = &grafo->grelha;
+    if (!g->frequencias || x < 0 || y < 0 || x >= g->colunas || y >= g->linhas) return;
+    uint64_t* palavra = &g->ocupacao[(size_t)y * g->palavras_linha + (x >> 6)];
+    uint64_t bit = 1ULL << (x & 63);
+    if (id < 0) {
+        *palavra &= ~bit;
+        g->frequencias[(size_t)y * g->colunas + x] = 0;
+    } else {
+        *palavra |= bit;
+        g->frequencias[(size_t)y * g->colunas + x] = (unsigned char)grafo->frequencias[id];
     }
+}
 
-    liberar_matriz(matriz, linhas);
+/**
+ * @brief Retira uma antena da tabela de coordenadas e da grelha densa.
+ *
+ * A antena sai da cadeia da sua célula: se era a primeira (a da tabela), a
+ * seguinte toma o seu lugar; se era a última (a da grelha), a grelha passa
+ * a mostrar a anterior. O custo é proporcional ao número de antenas na
+ * célula.
+ * @param grafo Ponteiro para o grafo (com a antena ainda no índice).
+ * @param antena Antena a retirar.
+ */
+void desindexar_antena(Grafo* grafo, Antena* antena) {
+    int id = antena->id;
+    int* seguinte = grafo->seguinte_celula;
+    int pos = grafo->tabela_coordenadas ? posicao_celula(grafo, antena->x, antena->y) : -1;
+    if (pos < 0) return;
+
+    int anterior = -1;
+    for (int atual = grafo->tabela_coordenadas[pos]; atual != id; atual = seguinte[atual]) anterior = atual;
+    if (anterior >= 0) seguinte[anterior] = seguinte[id];
+    else if (seguinte[id] >= 0) grafo->tabela_coordenadas[pos] = seguinte[id];
+    else apagar_coordenadas(grafo, pos);
+    if (seguinte[id] < 0) atualizar_celula(grafo, antena->x, antena->y, anterior);
+}
+
+/**
+ * @brief Muda o id de uma antena na tabela de coordenadas e na cadeia da sua célula.
+ *
+ * Usado por remover_antena quando a antena com o maior id (por isso a
+ * primeira da sua cadeia) passa a usar um id menor, com os atributos já
+ * copiados para esse id.
+ * @param grafo Ponteiro para o grafo.
+ * @param antigo Id anterior (o maior do grafo).
+ * @param novo Id novo.
+ */
+void renumerar_celula(Grafo* grafo, int antigo, int novo) {
+    int* seguinte = grafo->seguinte_celula;
+    int pos = posicao_celula(grafo, grafo->xs[novo], grafo->ys[novo]);
+    int resto = seguinte[antigo];
+    if (resto < novo) {
+        grafo->tabela_coordenadas[pos] = novo;
+        seguinte[novo] = resto;
+    } else {
+        grafo->tabela_coordenadas[pos] = resto;
+        int anterior = resto;
+        while (seguinte[anterior] > novo) anterior = seguinte[anterior];
+        seguinte[novo] = seguinte[anterior];
+        seguinte[anterior] = novo;
+    }
+    if (seguinte[novo] < 0) atualizar_celula(grafo, grafo->xs[novo], grafo->ys[novo], novo);
+}
+
+/**
+ * @brief Remove uma antena, atualizando apenas os buckets afetados.
+ *
+ * A antena com o maior id (sempre a última do seu bucket, a cabeça da
+ * lista de vértices e a primeira da cadeia da sua célula) é renumerada para
+ * o id libertado: o índice e a lista são corrigidos em O(1), a cadeia da
+ * célula e o bucket em tempo proporcional ao seu tamanho. Com a CSR, só as
+ * linhas das duas frequências alteradas são reescritas, no sítio.
+ */
+bool remover_antena(Grafo* grafo, Antena* antena) {
+    if (!antena || antena->id < 0 || antena->id >= grafo->num_vertices || grafo->indice[antena->id] != antena) {
+        return false;
+    }
+    if (grafo->membros && grafo->num_vertices_ligados != grafo->num_vertices) conectar_antenas(grafo);
+    bool ligado = grafo->membros && grafo->num_vertices_ligados == grafo->num_vertices;
+
+    int id = antena->id;
+    int ultimo = grafo->num_vertices - 1;
+    Antena* movida = grafo->indice[ultimo];
+    unsigned char f = (unsigned char)antena->frequencia;
+    unsigned char m = (unsigned char)movida->frequencia;
+    desindexar_antena(grafo, antena);
+
+    if (ligado) {
+        int tamanho = grafo->tamanho_frequencia[f];
+        int* bucket = grafo->membros_frequencia[f];
+        int pos = posicao_no_bucket(bucket, tamanho, id);
+        memmove(bucket + pos, bucket + pos + 1, (size_t)(tamanho - pos - 1) * sizeof(int));
+        grafo->tamanho_frequencia[f] = tamanho - 1;
+        grafo->num_arestas -= 2LL * (tamanho - 1);
+        if (tamanho == 1) rotular_componentes(grafo);
+
+        if (movida != antena) {
+            // O id da antena movida passa de último do bucket para a sua posição ordenada.
+            bucket = grafo->membros_frequencia[m];
+            int fim = grafo->tamanho_frequencia[m] - 1;
+            int destino = posicao_no_bucket(bucket, fim, id);
+            memmove(bucket + destino + 1, bucket + destino, (size_t)(fim - destino) * sizeof(int));
+            bucket[destino] = id;
+        }
+    }
+
+    // A lista de vértices está por id decrescente: o antecessor do id i é o id i+1.
+    Antena* anterior = id < ultimo ? grafo->indice[id + 1] : NULL;
+    if (anterior) anterior->prox = antena->prox;
+    else grafo->vertices = antena->prox;
+    if (movida != antena) {
+        grafo->vertices = movida->prox;
+        anterior = id + 1 < ultimo ? grafo->indice[id + 1] : NULL;
+        movida->prox = anterior ? anterior->prox : grafo->vertices;
+        if (anterior) anterior->prox = movida;
+        else grafo->vertices = movida;
+
+        movida->id = id;
+        grafo->indice[id] = movida;
+        grafo->frequencias[id] = grafo->frequencias[ultimo];
+        grafo->xs[id] = grafo->xs[ultimo];
+        grafo->ys[id] = grafo->ys[ultimo];
+        renumerar_celula(grafo, ultimo, id);
+        if (ligado && grafo->inicio_arestas) grafo->inicio_arestas[id] = grafo->inicio_arestas[ultimo];
+    }
+    grafo->num_vertices--;
+    if (ligado) grafo->num_vertices_ligados = grafo->num_vertices;
+
+    antena->id = -1;
+    antena->prox = grafo->antenas_livres;
+    grafo->antenas_livres = antena;
+    if (ligado && grafo->inicio_arestas) {
+        reescrever_linhas(grafo, f);
+        if (m != f) reescrever_linhas(grafo, m);
+    }
+    return true;
+}
+
+/**
+ * @brief Obtém os vizinhos de uma antena.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Antena de referência.
+ * @param ids Recebe o ponteiro para os ids dos vizinhos.
+ * @return Número de ids em @p ids (pode incluir a própria antena).
+ */
+int vizinhos_antena(Grafo* grafo, Antena* antena, const int** ids) {
+    if (antena->id >= grafo->num_vertices_ligados) {
+        *ids = NULL;
+        return 0;
+    }
+    unsigned char f = (unsigned char)antena->frequencia;
+    if (grafo->inicio_arestas) {
+        // Um grafo sem arestas carregado do formato binário não tem vetor de destinos.
+        const int* linhas = grafo->arestas_frequencia[f];
+        *ids = linhas ? linhas + grafo->inicio_arestas[antena->id] : NULL;
+        return grafo->tamanho_frequencia[f] - 1;
+    }
+    *ids = grafo->membros_frequencia[f];
+    return grafo->tamanho_frequencia[f];
+}
+
+/**
+ * @brief Obtém o id da componente conexa de uma antena.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Antena.
+ * @return Id da componente, ou -1 se a antena não estava ligada.
+ */
+int componente_antena(Grafo* grafo, Antena* antena) {
+    if (antena->id >= grafo->num_vertices_ligados) return -1;
+    return grafo->componente_frequencia[(unsigned char)antena->frequencia];
+}
+
+/**
+ * @brief Indica se existe caminho entre duas antenas.
+ * @param grafo Ponteiro para o grafo.
+ * @param a Primeira antena.
+ * @param b Segunda antena.
+ * @return true se @p b é alcançável a partir de @p a.
+ */
+bool alcancavel(Grafo* grafo, Antena* a, Antena* b) {
+    if (a == b) return true;
+    int ca = componente_antena(grafo, a);
+    return ca >= 0 && ca == componente_antena(grafo, b);
+}
+
+/**
+ * @brief Obtém os membros de uma componente conexa.
+ * @param grafo Ponteiro para o grafo.
+ * @param componente Id da componente.
+ * @param ids Recebe o ponteiro para os ids dos membros (usar grafo->indice).
+ * @return Número de membros (tamanho da componente), ou 0 se o id é inválido.
+ */
+int membros_componente(Grafo* grafo, int componente, const int** ids) {
+    if (componente < 0 || componente >= grafo->num_componentes) {
+        *ids = NULL;
+        return 0;
+    }
+    unsigned char f = grafo->frequencia_componente[componente];
+    *ids = grafo->membros_frequencia[f];
+    return grafo->tamanho_frequencia[f];
+}
+
+/**
+ * @brief Obtém o tamanho de uma componente conexa.
+ * @param grafo Ponteiro para o grafo.
+ * @param componente Id da componente.
+ * @return Número de antenas da componente.
+ */
+int tamanho_componente(Grafo* grafo, int componente) {
+    const int* ids;
+    return membros_componente(grafo, componente, &ids);
+}
+
+/**
+ * @brief Indica se a vizinhança de uma antena ainda precisa de ser percorrida.
+ *
+ * Numa clique implícita todas as antenas partilham a mesma lista de vizinhos,
+ * pelo que basta expandi-la uma vez por travessia (evita trabalho O(k²)).
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Antena a expandir.
+ * @param expandidos Frequências já expandidas nesta travessia.
+ * @return true se os vizinhos devem ser percorridos.
+ */
+bool expandir_vizinhanca(Grafo* grafo, Antena* antena, bool expandidos[256]) {
+    if (grafo->inicio_arestas) return true;
+    unsigned char f = (unsigned char)antena->frequencia;
+    if (expandidos[f]) return false;
+    expandidos[f] = true;
+    return true;
+}
+
+#if defined(_MSC_VER)
+#define LOCAL_THREAD __declspec(thread)
+#else
+#define LOCAL_THREAD _Thread_local
+#endif
+
+/**
+ * @struct ContextoConsulta
+ * @brief Estado de visita de uma consulta: a época da última visita de cada id.
+ *
+ * As travessias não escrevem no grafo; cada thread tem os seus contextos (ver
+ * contexto_consulta), pelo que várias consultas podem correr em simultâneo
+ * sobre o mesmo grafo. Uma consulta iniciada dentro de um callback usa o
+ * contexto seguinte da cadeia e não mexe no da consulta que a chamou.
+ */
+typedef struct ContextoConsulta {
+    unsigned int* visitas;   /**< Época da última visita, por id de antena. */
+    int capacidade;          /**< Número de ids com espaço em @c visitas. */
+    unsigned int epoca;      /**< Época atual: visitada significa visitas[id] == epoca. */
+    struct ContextoConsulta* seguinte; /**< Contexto da consulta aninhada seguinte (NULL se ainda não foi preciso). */
+} ContextoConsulta;
+
+/**
+ * @brief Primeiro contexto de consulta da thread atual.
+ */
+LOCAL_THREAD ContextoConsulta contexto_thread = {NULL, 0, 0, NULL};
+
+/**
+ * @brief Número de consultas em curso na thread atual (aninhadas através de callbacks).
+ */
+LOCAL_THREAD int consultas_ativas = 0;
+
+/**
+ * @brief Inicia uma nova marcação de "visitado" num contexto.
+ *
+ * Basta avançar a época de visita; só quando o contador dá a volta é que
+ * as marcas são efetivamente limpas.
+ */
+void avancar_epoca(ContextoConsulta* consulta) {
+    consulta->epoca++;
+    if (consulta->epoca == 0) {
+        if (consulta->visitas) memset(consulta->visitas, 0, (size_t)consulta->capacidade * sizeof(unsigned int));
+        consulta->epoca = 1;
+    }
+}
+
+/**
+ * @brief Obtém um contexto de consulta da thread atual, pronto para uma nova travessia.
+ *
+ * Cada consulta em curso na thread tem o seu contexto: uma consulta feita a
+ * partir de um callback recebe o seguinte da cadeia, criado na primeira vez
+ * que é preciso. O contexto cresce, se for preciso, até ao número de antenas
+ * do grafo e a época avança. Tem de ser devolvido com devolver_contexto_consulta.
+ * @return NULL se não houve memória.
+ */
+ContextoConsulta* contexto_consulta(Grafo* grafo) {
+    ContextoConsulta* consulta = &contexto_thread;
+    for (int d = 0; d < consultas_ativas; d++) {
+        if (!consulta->seguinte) {
+            consulta->seguinte = (ContextoConsulta*)calloc(1, sizeof(ContextoConsulta));
+            if (!consulta->seguinte) return NULL;
+        }
+        consulta = consulta->seguinte;
+    }
+    if (consulta->capacidade < grafo->num_vertices) {
+        int capacidade = consulta->capacidade * 2 > grafo->num_vertices ? consulta->capacidade * 2 : grafo->num_vertices;
+        unsigned int* visitas = (unsigned int*)realloc(consulta->visitas, (size_t)capacidade * sizeof(unsigned int));
+        if (!visitas) return NULL;
+        memset(visitas + consulta->capacidade, 0, (size_t)(capacidade - consulta->capacidade) * sizeof(unsigned int));
+        consulta->visitas = visitas;
+        consulta->capacidade = capacidade;
+    }
+    avancar_epoca(consulta);
+    consultas_ativas++;
+    return consulta;
+}
+
+/**
+ * @brief Devolve o contexto obtido por contexto_consulta no fim da consulta.
+ * @param consulta Contexto devolvido (NULL se a sua obtenção falhou).
+ */
+void devolver_contexto_consulta(ContextoConsulta* consulta) {
+    if (consulta) consultas_ativas--;
+}
+
+/**
+ * @brief Liberta os contextos de consulta da thread atual.
+ */
+void libertar_contexto_consulta(void) {
+    ContextoConsulta* consulta = contexto_thread.seguinte;
+    while (consulta) {
+        ContextoConsulta* seguinte = consulta->seguinte;
+        free(consulta->visitas);
+        free(consulta);
+        consulta = seguinte;
+    }
+    free(contexto_thread.visitas);
+    memset(&contexto_thread, 0, sizeof(contexto_thread));
+}
+
+/**
+ * @brief Reinicia o estado de visitado de todas as antenas.
+ *
+ * Mantida por compatibilidade: cada travessia já começa sem visitas.
+ */
+void reiniciar_visitas(Grafo* grafo) {
+    (void)grafo;
+}
+
+/**
+ * @brief Indica se uma antena já foi visitada na travessia atual.
+ */
+bool antena_visitada(const ContextoConsulta* consulta, const Antena* antena) {
+    return consulta->visitas[antena->id] == consulta->epoca;
+}
+
+/**
+ * @brief Marca uma antena como visitada na travessia atual.
+ */
+void marcar_visita(ContextoConsulta* consulta, const Antena* antena) {
+    consulta->visitas[antena->id] = consulta->epoca;
+}
+
+/**
+ * @struct QuadroPilha
+ * @brief Estado de uma antena na pilha explícita das buscas em profundidade.
+ */
+typedef struct {
+    Antena* antena;          /**< Antena deste nível. */
+    const int* vizinhos;     /**< Ids dos vizinhos a percorrer. */
+    int grau;                /**< Número de vizinhos. */
+    int pos;                 /**< Próximo vizinho a considerar. */
+} QuadroPilha;
+
+/**
+ * @struct PilhaBusca
+ * @brief Pilha explícita (crescente) usada pelas buscas em profundidade.
+ */
+typedef struct {
+    QuadroPilha* quadros;    /**< Quadros empilhados. */
+    int topo;                /**< Número de quadros na pilha. */
+    int capacidade;          /**< Capacidade alocada. */
+} PilhaBusca;
+
+/**
+ * @brief Empilha uma antena com a sua lista de vizinhos.
+ * @param grafo Ponteiro para o grafo.
+ * @param pilha Pilha da busca.
+ * @param antena Antena a empilhar.
+ * @param expandidos Frequências já expandidas, ou NULL para expandir sempre.
+ * @return false se não houve memória.
+ */
+bool empilhar_antena(Grafo* grafo, PilhaBusca* pilha, Antena* antena, bool expandidos[256]) {
+    if (pilha->topo == pilha->capacidade) {
+        int capacidade = pilha->capacidade ? pilha->capacidade * 2 : 64;
+        QuadroPilha* quadros = (QuadroPilha*)realloc(pilha->quadros, capacidade * sizeof(QuadroPilha));
+        if (!quadros) return false;
+        pilha->quadros = quadros;
+        pilha->capacidade = capacidade;
+    }
+    QuadroPilha* quadro = &pilha->quadros[pilha->topo++];
+    quadro->antena = antena;
+    quadro->pos = 0;
+    quadro->grau = 0;
+    quadro->vizinhos = NULL;
+    if (!expandidos || expandir_vizinhanca(grafo, antena, expandidos)) {
+        quadro->grau = vizinhos_antena(grafo, antena, &quadro->vizinhos);
+    }
+    return true;
+}
+
+/**
+ * @brief Executa busca em profundidade (DFS).
+ *
+ * Iterativa, com pilha explícita, para não esgotar a pilha de chamadas em
+ * classes de frequência grandes; a ordem de visita é a da versão recursiva.
+ * @param grafo Ponteiro para o grafo.
+ * @param inicio Antena inicial.
+ * @param callback Função chamada em cada antena visitada.
+ */
+void dfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*)) {
+    if (!inicio) return;
+    ESTATISTICA_INICIO(t0);
+    bool expandidos[256] = {false};
+    PilhaBusca pilha = {NULL, 0, 0};
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+    if (!consulta) return;
+
+    marcar_visita(consulta, inicio);
+    callback(inicio);
+    ESTATISTICA_SOMAR(grafo, vertices_visitados, 1);
+    if (!empilhar_antena(grafo, &pilha, inicio, expandidos)) pilha.topo = 0;
+
+    while (pilha.topo > 0) {
+        QuadroPilha* quadro = &pilha.quadros[pilha.topo - 1];
+        if (quadro->pos == quadro->grau) {
+            pilha.topo--;
+            continue;
+        }
+        Antena* proxima = grafo->indice[quadro->vizinhos[quadro->pos++]];
+        if (antena_visitada(consulta, proxima)) continue;
+        marcar_visita(consulta, proxima);
+        callback(proxima);
+        ESTATISTICA_SOMAR(grafo, vertices_visitados, 1);
+        if (!empilhar_antena(grafo, &pilha, proxima, expandidos)) break;
+    }
+
+    free(pilha.quadros);
+    devolver_contexto_consulta(consulta);
+    ESTATISTICA_FIM(grafo, dfs, t0);
+}
+
+/**
+ * @brief Executa busca em largura (BFS).
+ * @param grafo Ponteiro para o grafo.
+ * @param inicio Antena inicial.
+ * @param callback Função chamada em cada antena visitada.
+ */
+void bfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*)) {
+    if (!inicio) return;
+    ESTATISTICA_INICIO(t0);
+    bool expandidos[256] = {false};
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+    int* fila = (int*)malloc(grafo->num_vertices * sizeof(int));
+    if (!consulta || !fila) {
+        free(fila);
+        devolver_contexto_consulta(consulta);
+        return;
+    }
+    int inicio_fila = 0, fim_fila = 0;
+    fila[fim_fila++] = inicio->id;
+    marcar_visita(consulta, inicio);
+
+    while (inicio_fila < fim_fila) {
+        Antena* atual = grafo->indice[fila[inicio_fila++]];
+        callback(atual);
+        if (!expandir_vizinhanca(grafo, atual, expandidos)) continue;
+
+        const int* vizinhos;
+        int grau = vizinhos_antena(grafo, atual, &vizinhos);
+        for (int k = 0; k < grau; k++) {
+            Antena* destino = grafo->indice[vizinhos[k]];
+            if (!antena_visitada(consulta, destino)) {
+                fila[fim_fila++] = destino->id;
+                marcar_visita(consulta, destino);
+            }
+        }
+    }
+
+    free(fila);
+    devolver_contexto_consulta(consulta);
+    ESTATISTICA_SOMAR(grafo, vertices_visitados, fim_fila);
+    ESTATISTICA_FIM(grafo, bfs, t0);
+}
+
+/**
+ * @brief Ordena ids por ordem crescente.
+ */
+int comparar_ids_crescente(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+/**
+ * @brief Marca uma antena como visitada, indicando se foi esta chamada a fazê-lo.
+ *
+ * Com OpenMP a troca é atómica, para que cada antena seja reivindicada por
+ * uma única thread.
+ * @param visita Marca de visita da antena no contexto da consulta.
+ * @param epoca Época da travessia.
+ * @return true se a antena ainda não estava visitada.
+ */
+bool reivindicar_visita(unsigned int* visita, unsigned int epoca) {
+#ifdef _OPENMP
+    if (__atomic_load_n(visita, __ATOMIC_RELAXED) == epoca) return false;
+    return __atomic_exchange_n(visita, epoca, __ATOMIC_RELAXED) != epoca;
+#else
+    if (*visita == epoca) return false;
+    *visita = epoca;
+    return true;
+#endif
+}
+
+/**
+ * @brief Acrescenta um id ao buffer local de uma thread.
+ * @return false se não houve memória.
+ */
+bool acrescentar_local(int** buffer, int* tamanho, int* capacidade, int id) {
+    if (*tamanho == *capacidade) {
+        int nova_capacidade = *capacidade ? *capacidade * 2 : 1024;
+        int* novo = (int*)realloc(*buffer, nova_capacidade * sizeof(int));
+        if (!novo) return false;
+        *buffer = novo;
+        *capacidade = nova_capacidade;
+    }
+    (*buffer)[(*tamanho)++] = id;
+    return true;
+}
+
+/**
+ * @brief Expande a fronteira de cima para baixo, dividindo as arestas pelas threads.
+ *
+ * As listas de vizinhos da fronteira são vistas como uma sequência única de
+ * arestas, repartida em fatias iguais; cada thread reivindica os destinos
+ * ainda não visitados para o seu buffer local, que no fim é copiado para
+ * @p proxima.
+ * @return Tamanho da próxima fronteira, ou -1 se faltou memória.
+ */
+int expandir_cima_baixo(ContextoConsulta* consulta, const int** listas, const long long* acumulado, int tam_fronteira,
+                        int* proxima) {
+    unsigned int* visitas = consulta->visitas;
+    unsigned int epoca = consulta->epoca;
+    long long total = acumulado[tam_fronteira];
+    int tam_proxima = 0;
+    bool falhou = false;
+
+    #pragma omp parallel if (total > 4096)
+    {
+        int t = omp_get_thread_num(), num_threads = omp_get_num_threads();
+        long long e = total * t / num_threads, fim = total * (t + 1) / num_threads;
+        int* local = NULL;
+        int tam_local = 0, cap_local = 0;
+
+        int esq = 0, dir = tam_fronteira;
+        while (esq < dir) {
+            int meio = esq + (dir - esq) / 2;
+            if (acumulado[meio + 1] <= e) esq = meio + 1;
+            else dir = meio;
+        }
+        for (int k = esq; e < fim; k++) {
+            long long limite = acumulado[k + 1] < fim ? acumulado[k + 1] : fim;
+            for (; e < limite; e++) {
+                int w = listas[k][e - acumulado[k]];
+                if (reivindicar_visita(&visitas[w], epoca) &&
+                    !acrescentar_local(&local, &tam_local, &cap_local, w)) {
+                    #pragma omp atomic write
+                    falhou = true;
+                    e = fim;
+                    break;
+                }
+            }
+        }
+
+        int pos;
+        #pragma omp atomic capture
+        { pos = tam_proxima; tam_proxima += tam_local; }
+        if (tam_local > 0) memcpy(proxima + pos, local, tam_local * sizeof(int));
+        free(local);
+    }
+    return falhou ? -1 : tam_proxima;
+}
+
+/**
+ * @brief Expande a fronteira de baixo para cima (só com arestas materializadas).
+ *
+ * Cada antena por visitar procura, em paralelo, um vizinho no nível atual;
+ * compensa quando a fronteira é grande e a maioria das arestas seria
+ * desperdiçada em antenas já visitadas.
+ * @return Tamanho da próxima fronteira, ou -1 se faltou memória.
+ */
+int expandir_baixo_cima(Grafo* grafo, ContextoConsulta* consulta, int* nivel_de, int nivel, int* proxima) {
+    unsigned int* visitas = consulta->visitas;
+    unsigned int epoca = consulta->epoca;
+    int n = grafo->num_vertices_ligados;
+    int tam_proxima = 0;
+    bool falhou = false;
+
+    #pragma omp parallel
+    {
+        int* local = NULL;
+        int tam_local = 0, cap_local = 0;
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (int v = 0; v < n; v++) {
+            if (visitas[v] == epoca) continue;
+            Antena* antena = grafo->indice[v];
+            const int* vizinhos;
+            int grau = vizinhos_antena(grafo, antena, &vizinhos);
+            for (int k = 0; k < grau; k++) {
+                if (nivel_de[vizinhos[k]] == nivel) {
+                    visitas[v] = epoca;
+                    if (!acrescentar_local(&local, &tam_local, &cap_local, v)) {
+                        #pragma omp atomic write
+                        falhou = true;
+                    }
+                    break;
+                }
+            }
+        }
+
+        int pos;
+        #pragma omp atomic capture
+        { pos = tam_proxima; tam_proxima += tam_local; }
+        if (tam_local > 0) memcpy(proxima + pos, local, tam_local * sizeof(int));
+        free(local);
+    }
+    return falhou ? -1 : tam_proxima;
+}
+
+/**
+ * @brief Executa uma BFS paralela, sincronizada por níveis.
+ * @param grafo Ponteiro para o grafo.
+ * @param inicio Antena inicial.
+ * @param niveis Recebe o nível de cada antena (por id; -1 se inalcançável), ou NULL.
+ * @param callback Função chamada em cada antena visitada, ou NULL.
+ * @return false se faltou memória.
+ */
+bool bfs_paralela(Grafo* grafo, Antena* inicio, int* niveis, void (*callback)(Antena*)) {
+    if (!inicio) {
+        for (int i = 0; niveis && i < grafo->num_vertices; i++) niveis[i] = -1;
+        return true;
+    }
+    ESTATISTICA_INICIO(t0);
+    int n = grafo->num_vertices;
+    bool baixo_cima_possivel = grafo->inicio_arestas != NULL;
+    bool expandidos[256] = {false};
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+
+    int* fronteira = (int*)malloc((n + 1) * sizeof(int));
+    int* proxima = (int*)malloc((n + 1) * sizeof(int));
+    const int** listas = (const int**)malloc((n + 1) * sizeof(const int*));
+    long long* acumulado = (long long*)malloc((n + 2) * sizeof(long long));
+    int* nivel_de = niveis;
+    if (!nivel_de && baixo_cima_possivel) nivel_de = (int*)malloc((n + 1) * sizeof(int));
+    bool ok = consulta && fronteira && proxima && listas && acumulado && (nivel_de || !baixo_cima_possivel);
+
+    if (ok && nivel_de) {
+        for (int i = 0; i < n; i++) nivel_de[i] = -1;
+        nivel_de[inicio->id] = 0;
+    }
+    int tam_fronteira = 0;
+    if (ok) {
+        fronteira[tam_fronteira++] = inicio->id;
+        marcar_visita(consulta, inicio);
+    }
+    int visitados = 1;
+    double grau_medio = grafo->num_vertices_ligados > 0 ? (double)grafo->num_arestas / grafo->num_vertices_ligados : 0;
+
+    for (int nivel = 0; ok && tam_fronteira > 0; nivel++) {
+        if (callback) {
+            for (int k = 0; k < tam_fronteira; k++) callback(grafo->indice[fronteira[k]]);
+        }
+
+        // Listas de vizinhos da fronteira; cada clique implícita só é expandida uma vez.
+        acumulado[0] = 0;
+        for (int k = 0; k < tam_fronteira; k++) {
+            int grau = 0;
+            listas[k] = NULL;
+            Antena* antena = grafo->indice[fronteira[k]];
+            if (expandir_vizinhanca(grafo, antena, expandidos)) {
+                grau = vizinhos_antena(grafo, antena, &listas[k]);
+            }
+            acumulado[k + 1] = acumulado[k] + grau;
+        }
+
+        bool baixo_cima = baixo_cima_possivel &&
+                          acumulado[tam_fronteira] * 14.0 > (n - visitados) * grau_medio;
+        int tam_proxima = baixo_cima ? expandir_baixo_cima(grafo, consulta, nivel_de, nivel, proxima)
+                                     : expandir_cima_baixo(consulta, listas, acumulado, tam_fronteira, proxima);
+        if (tam_proxima < 0) {
+            ok = false;
+            break;
+        }
+
+        // Ordem determinística dentro de cada nível, independente das threads.
+        qsort(proxima, tam_proxima, sizeof(int), comparar_ids_crescente);
+        if (nivel_de) {
+            for (int k = 0; k < tam_proxima; k++) nivel_de[proxima[k]] = nivel + 1;
+        }
+        visitados += tam_proxima;
+
+        int* troca = fronteira;
+        fronteira = proxima;
+        proxima = troca;
+        tam_fronteira = tam_proxima;
+    }
+
+    if (nivel_de != niveis) free(nivel_de);
+    free(fronteira);
+    free(proxima);
+    free(listas);
+    free(acumulado);
+    devolver_contexto_consulta(consulta);
+    ESTATISTICA_SOMAR(grafo, vertices_visitados, visitados);
+    ESTATISTICA_FIM(grafo, bfs, t0);
+    return ok;
+}
+
+/**
+ * @brief Propaga um nível de uma BFS de várias fontes (uma por bit das máscaras).
+ *
+ * Com as arestas materializadas cada antena da fronteira passa a sua máscara
+ * aos vizinhos. Com as cliques implícitas as máscaras são primeiro agregadas
+ * por frequência, pelo que cada bucket é percorrido duas vezes por nível,
+ * em vez de uma vez por cada antena da fronteira.
+ */
+void propagar_mascaras(Grafo* grafo, const uint64_t* visita, uint64_t* proxima) {
+    if (grafo->inicio_arestas) {
+        for (int v = 0; v < grafo->num_vertices_ligados; v++) {
+            if (!visita[v]) continue;
+            const int* vizinhos;
+            int grau = vizinhos_antena(grafo, grafo->indice[v], &vizinhos);
+            for (int k = 0; k < grau; k++) proxima[vizinhos[k]] |= visita[v];
+        }
+        return;
+    }
+    for (int f = 0; f < 256; f++) {
+        const int* bucket = grafo->membros_frequencia[f];
+        int tamanho = grafo->tamanho_frequencia[f];
+        uint64_t agregada = 0;
+        for (int i = 0; i < tamanho; i++) agregada |= visita[bucket[i]];
+        if (!agregada) continue;
+        for (int i = 0; i < tamanho; i++) proxima[bucket[i]] |= agregada;
+    }
+}
+
+/**
+ * @brief Executa BFS a partir de várias antenas, 64 de cada vez.
+ */
+bool bfs_multiplas_fontes(Grafo* grafo, Antena** fontes, int num_fontes, int* distancias) {
+    ESTATISTICA_INICIO(t0);
+    int n = grafo->num_vertices;
+    int num_lotes = n > 0 ? (num_fontes + 63) / 64 : 0;
+    bool falhou = false;
+    long long alcancados = 0;
+
+    #pragma omp parallel if (num_lotes > 1) reduction(+ : alcancados)
+    {
+        // Vistas, fronteira atual e próxima fronteira, reutilizadas entre lotes.
+        uint64_t* mascaras = num_lotes > 0 ? (uint64_t*)malloc(3 * (size_t)n * sizeof(uint64_t)) : NULL;
+        if (num_lotes > 0 && !mascaras) falhou = true;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int lote = 0; lote < num_lotes; lote++) {
+            if (!mascaras) continue;
+            int primeira = lote * 64;
+            int tamanho = num_fontes - primeira < 64 ? num_fontes - primeira : 64;
+            uint64_t *vistas = mascaras, *visita = mascaras + n, *proxima = mascaras + 2 * (size_t)n;
+            int* linhas = distancias + (size_t)primeira * n;
+            memset(mascaras, 0, 3 * (size_t)n * sizeof(uint64_t));
+            memset(linhas, 0xFF, (size_t)tamanho * n * sizeof(int));
+
+            for (int b = 0; b < tamanho; b++) {
+                int id = fontes[primeira + b]->id;
+                vistas[id] |= 1ULL << b;
+                visita[id] |= 1ULL << b;
+                linhas[(size_t)b * n + id] = 0;
+            }
+            alcancados += tamanho;
+
+            for (int nivel = 1;; nivel++) {
+                propagar_mascaras(grafo, visita, proxima);
+                bool ativa = false;
+                for (int v = 0; v < n; v++) {
+                    uint64_t novas = proxima[v] & ~vistas[v];
+                    proxima[v] = 0;
+                    visita[v] = novas;
+                    if (!novas) continue;
+                    ativa = true;
+                    vistas[v] |= novas;
+                    alcancados += __builtin_popcountll(novas);
+                    while (novas) {
+                        int b = __builtin_ctzll(novas);
+                        novas &= novas - 1;
+                        linhas[(size_t)b * n + v] = nivel;
+                    }
+                }
+                if (!ativa) break;
+            }
+        }
+        free(mascaras);
+    }
+
+    ESTATISTICA_SOMAR(grafo, vertices_visitados, alcancados);
+    ESTATISTICA_FIM(grafo, bfs, t0);
+    return !falhou;
+}
+
+/**
+ * @brief Soma saturada de dois contadores não negativos.
+ */
+long long somar_saturado(long long a, long long b) {
+    return a > LLONG_MAX - b ? LLONG_MAX : a + b;
+}
+
+/**
+ * @brief Conta os caminhos simples entre duas antenas de uma clique implícita.
+ *
+ * Numa clique com k antenas há m = k-2 antenas intermédias possíveis e
+ * m!/(m-j)! caminhos com j intermédias; soma-se até ao limite de saltos.
+ * @param k Tamanho da clique.
+ * @param max_saltos Limite de saltos (0 = sem limite).
+ * @return Número de caminhos, saturado em LLONG_MAX.
+ */
+long long contar_caminhos_clique(int k, int max_saltos) {
+    int m = k - 2;
+    int max_intermedias = m;
+    if (max_saltos > 0 && max_saltos - 1 < max_intermedias) max_intermedias = max_saltos - 1;
+
+    long long total = 0, arranjos = 1;
+    for (int j = 0; j <= max_intermedias; j++) {
+        if (j > 0) {
+            long long fator = m - j + 1;
+            arranjos = arranjos > LLONG_MAX / fator ? LLONG_MAX : arranjos * fator;
+        }
+        total = somar_saturado(total, arranjos);
+        if (total == LLONG_MAX) break;
+    }
+    return total;
+}
+
+/**
+ * @brief Encontra caminhos entre duas antenas, com limites opcionais.
+ *
+ * Enumeração em profundidade com pilha explícita: uma antena fica marcada
+ * enquanto pertence ao caminho atual e é desmarcada ao sair da pilha. Sem
+ * callback e com cliques implícitas, a contagem é calculada diretamente.
+ */
+long long procurar_caminhos(Grafo* grafo, Antena* origem, Antena* destino, const LimitesCaminhos* limites,
+                            void (*callback)(Antena**, int)) {
+    int max_saltos = limites ? limites->max_saltos : 0;
+    long long max_resultados = limites && limites->max_resultados > 0 ? limites->max_resultados : LLONG_MAX;
+
+    if (origem == destino) {
+        if (callback) callback(&origem, 1);
+        return 1;
+    }
+    if (!alcancavel(grafo, origem, destino)) return 0;
+    if (!callback && !grafo->inicio_arestas) {
+        long long total = contar_caminhos_clique(tamanho_componente(grafo, componente_antena(grafo, origem)), max_saltos);
+        return total < max_resultados ? total : max_resultados;
+    }
+
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+    Antena** caminho = (Antena**)malloc(grafo->num_vertices * sizeof(Antena*));
+    PilhaBusca pilha = {NULL, 0, 0};
+    long long encontrados = 0;
+    if (!consulta || !caminho) {
+        free(caminho);
+        devolver_contexto_consulta(consulta);
+        return 0;
+    }
+
+    caminho[0] = origem;
+    marcar_visita(consulta, origem);
+    if (!empilhar_antena(grafo, &pilha, origem, NULL)) pilha.topo = 0;
+
+    while (pilha.topo > 0 && encontrados < max_resultados) {
+        QuadroPilha* quadro = &pilha.quadros[pilha.topo - 1];
+        if (quadro->pos == quadro->grau) {
+            consulta->visitas[quadro->antena->id] = 0;
+            pilha.topo--;
+            continue;
+        }
+        Antena* proxima = grafo->indice[quadro->vizinhos[quadro->pos++]];
+        if (antena_visitada(consulta, proxima)) continue;
+
+        // A próxima antena fica a pilha.topo saltos da origem.
+        caminho[pilha.topo] = proxima;
+        if (proxima == destino) {
+            encontrados++;
+            if (callback) callback(caminho, pilha.topo + 1);
+            continue;
+        }
+        if (max_saltos > 0 && pilha.topo >= max_saltos) continue;
+        marcar_visita(consulta, proxima);
+        if (!empilhar_antena(grafo, &pilha, proxima, NULL)) break;
+    }
+
+    free(pilha.quadros);
+    free(caminho);
+    devolver_contexto_consulta(consulta);
+    return encontrados;
+}
+
+/**
+ * @brief Encontra caminhos entre duas antenas, com limites opcionais.
+ */
+long long encontrar_caminhos_limitado(Grafo* grafo, Antena* origem, Antena* destino, const LimitesCaminhos* limites,
+                                      void (*callback)(Antena**, int)) {
+    ESTATISTICA_INICIO(t0);
+    long long total = procurar_caminhos(grafo, origem, destino, limites, callback);
+    ESTATISTICA_SOMAR(grafo, caminhos_emitidos, total);
+    ESTATISTICA_FIM(grafo, caminhos, t0);
+    return total;
+}
+
+/**
+ * @brief Encontra todos os caminhos entre duas antenas.
+ */
+void encontrar_caminhos(Grafo* grafo, Antena* origem, Antena* destino, void (*callback)(Antena**, int)) {
+    encontrar_caminhos_limitado(grafo, origem, destino, NULL, callback);
+}
+
+/**
+ * @brief Reserva a entrega de um caminho no contador global da enumeração paralela.
+ * @return true se o caminho ainda cabe no limite de resultados.
+ */
+bool reservar_resultado(long long* total, long long max_resultados) {
+    long long pos;
+    #pragma omp atomic capture
+    pos = (*total)++;
+    return pos < max_resultados;
+}
+
+/**
+ * @brief Entrega um caminho ao callback, serializando as chamadas entre threads.
+ */
+void entregar_caminho(void (*callback)(Antena**, int), Antena** caminho, int tamanho) {
+    if (!callback) return;
+    #pragma omp critical(entrega_caminhos)
+    callback(caminho, tamanho);
+}
+
+#define TAREFAS_POR_THREAD 16      /**< Tarefas da enumeração paralela por thread. */
+#define PROFUNDIDADE_PREFIXOS 8    /**< Comprimento máximo dos prefixos expandidos em largura. */
+
+/**
+ * @struct EspacoEnumeracao
+ * @brief Memória de trabalho de uma thread na enumeração paralela de caminhos.
+ *
+ * Alocada uma vez por thread antes da região paralela e reutilizada por
+ * todas as tarefas que a thread executa.
+ */
+typedef struct {
+    unsigned char* visitados; /**< Bitset das antenas do caminho atual (limpo entre prefixos). */
+    Antena** caminho;         /**< Caminho atual. */
+    PilhaBusca pilha;         /**< Pilha da DFS. */
+} EspacoEnumeracao;
+
+/**
+ * @brief Enumera todos os caminhos que começam por um prefixo.
+ *
+ * Usa a memória de trabalho da thread que a executa e deixa o bitset de
+ * visitados limpo no fim, mesmo quando pára no limite de resultados.
+ * @return false se faltou memória.
+ */
+bool enumerar_subarvore(Grafo* grafo, EspacoEnumeracao* espaco, const int* prefixo, int tam_prefixo, Antena* destino,
+                        int max_saltos, long long max_resultados, long long* total, void (*callback)(Antena**, int)) {
+    unsigned char* visitados = espaco->visitados;
+    Antena** caminho = espaco->caminho;
+    PilhaBusca* pilha = &espaco->pilha;
+    for (int i = 0; i < tam_prefixo; i++) {
+        visitados[prefixo[i] >> 3] |= (unsigned char)(1u << (prefixo[i] & 7));
+        caminho[i] = grafo->indice[prefixo[i]];
+    }
+    pilha->topo = 0;
+    bool ok = empilhar_antena(grafo, pilha, caminho[tam_prefixo - 1], NULL);
+
+    while (ok && pilha->topo > 0) {
+        long long entregues;
+        #pragma omp atomic read
+        entregues = *total;
+        if (entregues >= max_resultados) break;
+
+        QuadroPilha* quadro = &pilha->quadros[pilha->topo - 1];
+        if (quadro->pos == quadro->grau) {
+            int id = quadro->antena->id;
+            if (pilha->topo > 1) visitados[id >> 3] &= (unsigned char)~(1u << (id & 7));
+            pilha->topo--;
+            continue;
+        }
+        int w = quadro->vizinhos[quadro->pos++];
+        if (visitados[w >> 3] & (1u << (w & 7))) continue;
+
+        // A próxima antena fica a saltos saltos da origem.
+        int saltos = tam_prefixo - 1 + pilha->topo;
+        caminho[saltos] = grafo->indice[w];
+        if (caminho[saltos] == destino) {
+            if (reservar_resultado(total, max_resultados)) entregar_caminho(callback, caminho, saltos + 1);
+            continue;
+        }
+        if (max_saltos > 0 && saltos >= max_saltos) continue;
+        ok = empilhar_antena(grafo, pilha, caminho[saltos], NULL);
+        if (ok) visitados[w >> 3] |= (unsigned char)(1u << (w & 7));
+    }
+
+    for (int f = 1; f < pilha->topo; f++) {
+        int id = pilha->quadros[f].antena->id;
+        visitados[id >> 3] &= (unsigned char)~(1u << (id & 7));
+    }
+    for (int i = 0; i < tam_prefixo; i++) visitados[prefixo[i] >> 3] &= (unsigned char)~(1u << (prefixo[i] & 7));
+    pilha->topo = 0;
+    return ok;
+}
+
+/**
+ * @brief Enumera caminhos entre duas antenas em paralelo.
+ *
+ * A árvore de pesquisa é dividida por prefixos: os caminhos parciais são
+ * expandidos nível a nível (até PROFUNDIDADE_PREFIXOS antenas) até haver
+ * prefixos suficientes para as threads. Os prefixos são depois agrupados em
+ * no máximo TAREFAS_POR_THREAD tarefas OpenMP por thread, distribuídas pelo
+ * escalonador de tarefas do runtime; cada tarefa usa a memória de trabalho
+ * da thread que a executa, alocada uma só vez.
+ */
+long long procurar_caminhos_paralelo(Grafo* grafo, Antena* origem, Antena* destino, const LimitesCaminhos* limites,
+                                     void (*callback)(Antena**, int)) {
+    int max_saltos = limites ? limites->max_saltos : 0;
+    long long max_resultados = limites && limites->max_resultados > 0 ? limites->max_resultados : LLONG_MAX;
+
+    if (origem == destino) {
+        if (callback) callback(&origem, 1);
+        return 1;
+    }
+    if (!alcancavel(grafo, origem, destino)) return 0;
+
+    int n = grafo->num_vertices;
+    int num_threads = omp_get_max_threads();
+    long long alvo = (long long)TAREFAS_POR_THREAD * num_threads;
+    long long total = 0;
+    Antena** caminho = (Antena**)malloc((n + 1) * sizeof(Antena*));
+    int* prefixos = (int*)malloc(sizeof(int));
+    EspacoEnumeracao* espacos = (EspacoEnumeracao*)calloc(num_threads, sizeof(EspacoEnumeracao));
+    long long num_prefixos = 1;
+    int tam = 1;
+    bool ok = caminho && prefixos && espacos;
+    if (ok) prefixos[0] = origem->id;
+
+    // Expansão em largura dos prefixos; caminhos curtos completos são entregues já aqui.
+    while (ok && num_prefixos > 0 && num_prefixos < alvo && tam < PROFUNDIDADE_PREFIXOS &&
+           (max_saltos == 0 || tam <= max_saltos)) {
+        long long capacidade = 0;
+        for (long long p = 0; p < num_prefixos; p++) {
+            const int* vizinhos;
+            capacidade += vizinhos_antena(grafo, grafo->indice[prefixos[p * tam + tam - 1]], &vizinhos);
+        }
+        int* novos = (int*)malloc((size_t)(capacidade > 0 ? capacidade : 1) * (tam + 1) * sizeof(int));
+        if (!novos) {
+            ok = false;
+            break;
+        }
+        long long num_novos = 0;
+        for (long long p = 0; p < num_prefixos && total < max_resultados; p++) {
+            const int* prefixo = prefixos + p * tam;
+            const int* vizinhos;
+            int grau = vizinhos_antena(grafo, grafo->indice[prefixo[tam - 1]], &vizinhos);
+            for (int k = 0; k < grau && total < max_resultados; k++) {
+                int w = vizinhos[k];
+                bool repetida = false;
+                for (int i = 0; i < tam && !repetida; i++) repetida = prefixo[i] == w;
+                if (repetida) continue;
+                if (w == destino->id) {
+                    for (int i = 0; i < tam; i++) caminho[i] = grafo->indice[prefixo[i]];
+                    caminho[tam] = destino;
+                    total++;
+                    if (callback) callback(caminho, tam + 1);
+                } else if (max_saltos == 0 || tam < max_saltos) {
+                    memcpy(novos + num_novos * (tam + 1), prefixo, tam * sizeof(int));
+                    novos[num_novos * (tam + 1) + tam] = w;
+                    num_novos++;
+                }
+            }
+        }
+        free(prefixos);
+        prefixos = novos;
+        num_prefixos = total < max_resultados ? num_novos : 0;
+        tam++;
+    }
+
+    for (int t = 0; ok && num_prefixos > 0 && t < num_threads; t++) {
+        espacos[t].visitados = (unsigned char*)calloc((size_t)n / 8 + 1, 1);
+        espacos[t].caminho = (Antena**)malloc((n + 1) * sizeof(Antena*));
+        ok = espacos[t].visitados && espacos[t].caminho;
+    }
+
+    bool falhou = !ok;
+    if (ok && num_prefixos > 0) {
+        long long por_tarefa = (num_prefixos + alvo - 1) / alvo;
+        #pragma omp parallel num_threads(num_threads)
+        #pragma omp single
+        for (long long inicio = 0; inicio < num_prefixos; inicio += por_tarefa) {
+            long long fim = inicio + por_tarefa < num_prefixos ? inicio + por_tarefa : num_prefixos;
+            #pragma omp task firstprivate(inicio, fim)
+            {
+                EspacoEnumeracao* espaco = &espacos[omp_get_thread_num()];
+                for (long long p = inicio; p < fim; p++) {
+                    if (!enumerar_subarvore(grafo, espaco, prefixos + p * tam, tam, destino, max_saltos, max_resultados,
+                                            &total, callback)) {
+                        #pragma omp atomic write
+                        falhou = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int t = 0; espacos && t < num_threads; t++) {
+        free(espacos[t].visitados);
+        free(espacos[t].caminho);
+        free(espacos[t].pilha.quadros);
+    }
+    free(espacos);
+    free(prefixos);
+    free(caminho);
+    if (falhou) return -1;
+    return total < max_resultados ? total : max_resultados;
+}
+
+/**
+ * @brief Enumera caminhos entre duas antenas em paralelo.
+ */
+long long encontrar_caminhos_paralelo(Grafo* grafo, Antena* origem, Antena* destino, const LimitesCaminhos* limites,
+                                      void (*callback)(Antena**, int)) {
+    ESTATISTICA_INICIO(t0);
+    long long total = procurar_caminhos_paralelo(grafo, origem, destino, limites, callback);
+    if (total > 0) ESTATISTICA_SOMAR(grafo, caminhos_emitidos, total);
+    ESTATISTICA_FIM(grafo, caminhos, t0);
+    return total;
+}
+
+/**
+ * @brief Reconstrói um caminho a partir dos predecessores das duas buscas.
+ * @param grafo Ponteiro para o grafo.
+ * @param pai_origem Predecessores na busca a partir da origem (-1 na origem).
+ * @param pai_destino Sucessores na busca a partir do destino (-1 no destino).
+ * @param u Última antena do lado da origem.
+ * @param w Primeira antena do lado do destino.
+ * @param caminho Recebe o caminho.
+ * @return Número de antenas do caminho.
+ */
+int juntar_caminho(Grafo* grafo, const int* pai_origem, const int* pai_destino, int u, int w, Antena** caminho) {
+    int tamanho = 0;
+    for (int v = u; v >= 0; v = pai_origem[v]) caminho[tamanho++] = grafo->indice[v];
+    for (int a = 0, b = tamanho - 1; a < b; a++, b--) {
+        Antena* troca = caminho[a];
+        caminho[a] = caminho[b];
+        caminho[b] = troca;
+    }
+    for (int v = w; v >= 0; v = pai_destino[v]) caminho[tamanho++] = grafo->indice[v];
+    return tamanho;
+}
+
+/**
+ * @brief Expande um nível de um dos lados da BFS bidirecional.
+ *
+ * Regista o melhor encontro (menor soma de distâncias) com o outro lado.
+ * @return Tamanho da nova fronteira deste lado.
+ */
+int expandir_nivel_bidirecional(Grafo* grafo, unsigned int* visitas, int* fronteira, int tam, int* nova,
+                                unsigned int epoca, unsigned int epoca_outro, int* pai, int* dist, const int* dist_outro,
+                                bool expandidos[256], int* melhor, int* melhor_u, int* melhor_w) {
+    int tam_nova = 0;
+    for (int k = 0; k < tam; k++) {
+        Antena* atual = grafo->indice[fronteira[k]];
+        if (!expandir_vizinhanca(grafo, atual, expandidos)) continue;
+        const int* vizinhos;
+        int grau = vizinhos_antena(grafo, atual, &vizinhos);
+        for (int i = 0; i < grau; i++) {
+            Antena* vizinho = grafo->indice[vizinhos[i]];
+            if (visitas[vizinho->id] == epoca_outro) {
+                int total = dist[atual->id] + 1 + dist_outro[vizinho->id];
+                if (*melhor < 0 || total < *melhor) {
+                    *melhor = total;
+                    *melhor_u = atual->id;
+                    *melhor_w = vizinho->id;
+                }
+            } else if (visitas[vizinho->id] != epoca) {
+                visitas[vizinho->id] = epoca;
+                pai[vizinho->id] = atual->id;
+                dist[vizinho->id] = dist[atual->id] + 1;
+                nova[tam_nova++] = vizinho->id;
+            }
+        }
+    }
+    return tam_nova;
+}
+
+/**
+ * @brief Encontra um caminho com o menor número de saltos (BFS bidirecional).
+ *
+ * As duas buscas usam épocas de visita consecutivas, pelo que não há
+ * inicialização O(V); em cada passo é expandido o lado com menor fronteira.
+ * @return Número de antenas do caminho, 0 se não existe, -1 sem memória.
+ */
+int procurar_caminho_mais_curto(Grafo* grafo, Antena* origem, Antena* destino, Antena** caminho) {
+    if (origem == destino) {
+        caminho[0] = origem;
+        return 1;
+    }
+    if (!alcancavel(grafo, origem, destino)) return 0;
+
+    int n = grafo->num_vertices;
+    int* pai = (int*)malloc(2 * (size_t)n * sizeof(int));
+    int* dist = (int*)malloc(2 * (size_t)n * sizeof(int));
+    int* filas = (int*)malloc(4 * (size_t)n * sizeof(int));
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+    if (!pai || !dist || !filas || !consulta) {
+        free(pai);
+        free(dist);
+        free(filas);
+        devolver_contexto_consulta(consulta);
+        return -1;
+    }
+    int *pai_o = pai, *pai_d = pai + n, *dist_o = dist, *dist_d = dist + n;
+    int *fronteira_o = filas, *nova_o = filas + n, *fronteira_d = filas + 2 * (size_t)n, *nova_d = filas + 3 * (size_t)n;
+    bool expandidos_o[256] = {false}, expandidos_d[256] = {false};
+
+    unsigned int epoca_o = consulta->epoca;
+    avancar_epoca(consulta);
+    unsigned int epoca_d = consulta->epoca;
+    unsigned int* visitas = consulta->visitas;
+
+    visitas[origem->id] = epoca_o;
+    pai_o[origem->id] = -1;
+    dist_o[origem->id] = 0;
+    visitas[destino->id] = epoca_d;
+    pai_d[destino->id] = -1;
+    dist_d[destino->id] = 0;
+    fronteira_o[0] = origem->id;
+    fronteira_d[0] = destino->id;
+    int tam_o = 1, tam_d = 1;
+    int melhor = -1, melhor_u = -1, melhor_w = -1;
+
+    while (melhor < 0 && tam_o > 0 && tam_d > 0) {
+        if (tam_o <= tam_d) {
+            tam_o = expandir_nivel_bidirecional(grafo, visitas, fronteira_o, tam_o, nova_o, epoca_o, epoca_d, pai_o, dist_o,
+                                                dist_d, expandidos_o, &melhor, &melhor_u, &melhor_w);
+            int* troca = fronteira_o; fronteira_o = nova_o; nova_o = troca;
+        } else {
+            tam_d = expandir_nivel_bidirecional(grafo, visitas, fronteira_d, tam_d, nova_d, epoca_d, epoca_o, pai_d, dist_d,
+                                                dist_o, expandidos_d, &melhor, &melhor_w, &melhor_u);
+            int* troca = fronteira_d; fronteira_d = nova_d; nova_d = troca;
+        }
+    }
+
+    int tamanho = melhor < 0 ? 0 : juntar_caminho(grafo, pai_o, pai_d, melhor_u, melhor_w, caminho);
+    free(pai);
+    free(dist);
+    free(filas);
+    devolver_contexto_consulta(consulta);
+    return tamanho;
+}
+
+/**
+ * @brief Encontra um caminho com o menor número de saltos.
+ */
+int caminho_mais_curto(Grafo* grafo, Antena* origem, Antena* destino, Antena** caminho) {
+    ESTATISTICA_INICIO(t0);
+    int tamanho = procurar_caminho_mais_curto(grafo, origem, destino, caminho);
+    if (tamanho > 0) ESTATISTICA_SOMAR(grafo, caminhos_emitidos, 1);
+    ESTATISTICA_FIM(grafo, caminho_mais_curto, t0);
+    return tamanho;
+}
+
+/**
+ * @brief BFS de desvio do algoritmo de Yen, com antenas e arestas proibidas.
+ *
+ * As antenas proibidas já vêm marcadas com a época atual de @p consulta. As
+ * arestas proibidas saem todas da antena de desvio. Termina assim que o
+ * destino é descoberto.
+ * @return Número de antenas do caminho (em @p caminho, ids), 0 se não existe.
+ */
+int bfs_desvio(Grafo* grafo, ContextoConsulta* consulta, int desvio, int destino, const int* proibidas,
+               int num_proibidas, int* pai, int* fila, int* caminho) {
+    unsigned int* visitas = consulta->visitas;
+    unsigned int epoca = consulta->epoca;
+    int inicio_fila = 0, fim_fila = 0;
+    fila[fim_fila++] = desvio;
+    visitas[desvio] = epoca;
+    pai[desvio] = -1;
+
+    while (inicio_fila < fim_fila) {
+        int atual = fila[inicio_fila++];
+        const int* vizinhos;
+        int grau = vizinhos_antena(grafo, grafo->indice[atual], &vizinhos);
+        for (int k = 0; k < grau; k++) {
+            int w = vizinhos[k];
+            if (visitas[w] == epoca) continue;
+            if (atual == desvio) {
+                bool proibida = false;
+                for (int p = 0; p < num_proibidas && !proibida; p++) proibida = proibidas[p] == w;
+                if (proibida) continue;
+            }
+            visitas[w] = epoca;
+            pai[w] = atual;
+            if (w == destino) {
+                int tamanho = 0;
+                for (int v = w; v >= 0; v = pai[v]) caminho[tamanho++] = v;
+                for (int a = 0, b = tamanho - 1; a < b; a++, b--) {
+                    int troca = caminho[a];
+                    caminho[a] = caminho[b];
+                    caminho[b] = troca;
+                }
+                return tamanho;
+            }
+            fila[fim_fila++] = w;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @struct CaminhoYen
+ * @brief Caminho (em ids) guardado pelo algoritmo de Yen.
+ */
+typedef struct {
+    int* ids;                /**< Antenas do caminho. */
+    int tamanho;             /**< Número de antenas. */
+} CaminhoYen;
+
+/**
+ * @brief Compara dois caminhos por tamanho e, em empate, pelos ids.
+ *
+ * O desempate só torna determinística a escolha entre os candidatos já
+ * gerados; não ordena lexicograficamente todos os caminhos do mesmo tamanho.
+ */
+int comparar_caminhos_yen(const CaminhoYen* a, const CaminhoYen* b) {
+    if (a->tamanho != b->tamanho) return a->tamanho - b->tamanho;
+    for (int i = 0; i < a->tamanho; i++) {
+        if (a->ids[i] != b->ids[i]) return a->ids[i] - b->ids[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief Encontra os k caminhos simples mais curtos (algoritmo de Yen).
+ */
+int k_caminhos_mais_curtos(Grafo* grafo, Antena* origem, Antena* destino, int k, void (*callback)(Antena**, int)) {
+    if (k <= 0) return 0;
+    ESTATISTICA_INICIO(t0);
+    int n = grafo->num_vertices;
+    Antena** caminho = (Antena**)malloc((n + 1) * sizeof(Antena*));
+    int* pai = (int*)malloc((n + 1) * sizeof(int));
+    int* fila = (int*)malloc((n + 1) * sizeof(int));
+    int* desvio = (int*)malloc((n + 1) * sizeof(int));
+    int* proibidas = (int*)malloc((k + 1) * sizeof(int));
+    CaminhoYen* aceites = (CaminhoYen*)malloc(k * sizeof(CaminhoYen));
+    CaminhoYen* candidatos = NULL;
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+    int num_aceites = 0, num_candidatos = 0, cap_candidatos = 0;
+    if (!caminho || !pai || !fila || !desvio || !proibidas || !aceites || !consulta) goto fim;
+
+    int tamanho = procurar_caminho_mais_curto(grafo, origem, destino, caminho);
+    if (tamanho <= 0) goto fim;
+    aceites[0].ids = (int*)malloc(tamanho * sizeof(int));
+    if (!aceites[0].ids) goto fim;
+    for (int i = 0; i < tamanho; i++) aceites[0].ids[i] = caminho[i]->id;
+    aceites[0].tamanho = tamanho;
+    num_aceites = 1;
+
+    while (num_aceites < k) {
+        CaminhoYen* anterior = &aceites[num_aceites - 1];
+        for (int i = 0; i + 1 < anterior->tamanho; i++) {
+            // Arestas já usadas a partir da mesma raiz ficam proibidas.
+            int num_proibidas = 0;
+            for (int a = 0; a < num_aceites; a++) {
+                if (aceites[a].tamanho > i + 1 &&
+                    memcmp(aceites[a].ids, anterior->ids, (i + 1) * sizeof(int)) == 0) {
+                    proibidas[num_proibidas++] = aceites[a].ids[i + 1];
+                }
+            }
+            avancar_epoca(consulta);
+            for (int r = 0; r < i; r++) consulta->visitas[anterior->ids[r]] = consulta->epoca;
+            int tam_desvio = bfs_desvio(grafo, consulta, anterior->ids[i], destino->id, proibidas, num_proibidas, pai, fila, desvio);
+            if (tam_desvio == 0) continue;
+
+            CaminhoYen novo;
+            novo.tamanho = i + tam_desvio;
+            novo.ids = (int*)malloc(novo.tamanho * sizeof(int));
+            if (!novo.ids) goto fim;
+            memcpy(novo.ids, anterior->ids, i * sizeof(int));
+            memcpy(novo.ids + i, desvio, tam_desvio * sizeof(int));
+
+            bool repetido = false;
+            for (int c = 0; c < num_candidatos && !repetido; c++) {
+                repetido = comparar_caminhos_yen(&candidatos[c], &novo) == 0;
+            }
+            if (repetido) {
+                free(novo.ids);
+                continue;
+            }
+            if (num_candidatos == cap_candidatos) {
+                int capacidade = cap_candidatos ? cap_candidatos * 2 : 16;
+                CaminhoYen* mais = (CaminhoYen*)realloc(candidatos, capacidade * sizeof(CaminhoYen));
+                if (!mais) {
+                    free(novo.ids);
+                    goto fim;
+                }
+                candidatos = mais;
+                cap_candidatos = capacidade;
+            }
+            candidatos[num_candidatos++] = novo;
+        }
+        if (num_candidatos == 0) break;
+
+        int melhor = 0;
+        for (int c = 1; c < num_candidatos; c++) {
+            if (comparar_caminhos_yen(&candidatos[c], &candidatos[melhor]) < 0) melhor = c;
+        }
+        aceites[num_aceites++] = candidatos[melhor];
+        candidatos[melhor] = candidatos[--num_candidatos];
+    }
+
+    if (callback) {
+        for (int a = 0; a < num_aceites; a++) {
+            for (int i = 0; i < aceites[a].tamanho; i++) caminho[i] = grafo->indice[aceites[a].ids[i]];
+            callback(caminho, aceites[a].tamanho);
+        }
+    }
+
+fim:
+    for (int a = 0; aceites && a < num_aceites; a++) free(aceites[a].ids);
+    for (int c = 0; c < num_candidatos; c++) free(candidatos[c].ids);
+    free(candidatos);
+    free(aceites);
+    free(proibidas);
+    free(desvio);
+    free(fila);
+    free(pai);
+    free(caminho);
+    devolver_contexto_consulta(consulta);
+    ESTATISTICA_SOMAR(grafo, caminhos_emitidos, num_aceites);
+    ESTATISTICA_FIM(grafo, k_caminhos, t0);
+    return num_aceites;
+}
+
+/**
+ * @brief Distância euclidiana entre as coordenadas de duas antenas.
+ */
+double distancia_euclidiana(const Antena* a, const Antena* b, void* contexto) {
+    (void)contexto;
+    double dx = (double)a->x - b->x, dy = (double)a->y - b->y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * @brief Distância de Manhattan entre as coordenadas de duas antenas.
+ */
+double distancia_manhattan(const Antena* a, const Antena* b, void* contexto) {
+    (void)contexto;
+    return fabs((double)a->x - b->x) + fabs((double)a->y - b->y);
+}
+
+/**
+ * @struct EntradaHeap
+ * @brief Entrada da heap de prioridades dos caminhos ponderados.
+ */
+typedef struct {
+    double prioridade;       /**< Custo acumulado mais a heurística. */
+    double custo;            /**< Custo acumulado quando a entrada foi inserida. */
+    int id;                  /**< Id da antena. */
+} EntradaHeap;
+
+/**
+ * @struct HeapCustos
+ * @brief Heap binária mínima por prioridade (com remoção preguiçosa).
+ */
+typedef struct {
+    EntradaHeap* entradas;   /**< Entradas, com a menor na posição 0. */
+    int tamanho;             /**< Número de entradas. */
+    int capacidade;          /**< Capacidade de @c entradas. */
+} HeapCustos;
+
+/**
+ * @brief Insere uma entrada na heap.
+ * @return false se não houve memória.
+ */
+bool inserir_heap(HeapCustos* heap, double prioridade, double custo, int id) {
+    if (heap->tamanho == heap->capacidade) {
+        int capacidade = heap->capacidade ? 2 * heap->capacidade : 64;
+        EntradaHeap* novas = (EntradaHeap*)realloc(heap->entradas, (size_t)capacidade * sizeof(EntradaHeap));
+        if (!novas) return false;
+        heap->entradas = novas;
+        heap->capacidade = capacidade;
+    }
+    int i = heap->tamanho++;
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (heap->entradas[pai].prioridade <= prioridade) break;
+        heap->entradas[i] = heap->entradas[pai];
+        i = pai;
+    }
+    heap->entradas[i] = (EntradaHeap){prioridade, custo, id};
+    return true;
+}
+
+/**
+ * @brief Retira a entrada com menor prioridade (a heap não pode estar vazia).
+ */
+EntradaHeap retirar_heap(HeapCustos* heap) {
+    EntradaHeap topo = heap->entradas[0];
+    EntradaHeap ultima = heap->entradas[--heap->tamanho];
+    int i = 0;
+    for (;;) {
+        int filho = 2 * i + 1;
+        if (filho >= heap->tamanho) break;
+        if (filho + 1 < heap->tamanho && heap->entradas[filho + 1].prioridade < heap->entradas[filho].prioridade)
+            filho++;
+        if (ultima.prioridade <= heap->entradas[filho].prioridade) break;
+        heap->entradas[i] = heap->entradas[filho];
+        i = filho;
+    }
+    if (heap->tamanho > 0) heap->entradas[i] = ultima;
+    return topo;
+}
+
+/**
+ * @brief Pesquisa comum a caminho_dijkstra e caminho_a_estrela.
+ *
+ * Os custos acumulados só são válidos para as antenas marcadas com a época
+ * da pesquisa, pelo que não há inicialização O(V). Entradas obsoletas da
+ * heap (cujo custo já foi melhorado) são ignoradas ao serem retiradas; com
+ * uma heurística admissível mas inconsistente as antenas podem ser
+ * reabertas, o que mantém o resultado ótimo.
+ * @return Número de antenas do caminho, 0 se não existe, -1 sem memória.
+ */
+int procurar_caminho_ponderado(Grafo* grafo, Antena* origem, Antena* destino, const CustoArestas* custos,
+                               bool a_estrela, Antena** caminho, double* custo_total) {
+    FuncaoCusto custo = custos && custos->custo ? custos->custo : distancia_euclidiana;
+    void* contexto = custos ? custos->contexto : NULL;
+    bool metrica = custo == distancia_euclidiana || custo == distancia_manhattan;
+    FuncaoCusto heuristica = a_estrela && custos ? custos->heuristica : NULL;
+
+    if (origem == destino) {
+        caminho[0] = origem;
+        if (custo_total) *custo_total = 0.0;
+        return 1;
+    }
+    if (!alcancavel(grafo, origem, destino)) return 0;
+    if (metrica) {
+        // Cada frequência é uma clique e a métrica satisfaz a desigualdade
+        // triangular: nenhum desvio é mais barato do que a ligação direta. A
+        // heap (e a heurística do A*) só são usadas com custos próprios.
+        caminho[0] = origem;
+        caminho[1] = destino;
+        if (custo_total) *custo_total = custo(origem, destino, contexto);
+        return 2;
+    }
+
+    int n = grafo->num_vertices;
+    double* acumulado = (double*)malloc((size_t)n * sizeof(double));
+    int* pai = (int*)malloc((size_t)n * sizeof(int));
+    HeapCustos heap = {NULL, 0, 0};
+    ContextoConsulta* consulta = contexto_consulta(grafo);
+    int tamanho = -1;
+    long long expandidas = 0;
+    if (!acumulado || !pai || !consulta) goto fim;
+
+    unsigned int* visitas = consulta->visitas;
+    unsigned int epoca = consulta->epoca;
+    visitas[origem->id] = epoca;
+    acumulado[origem->id] = 0.0;
+    pai[origem->id] = -1;
+    if (!inserir_heap(&heap, heuristica ? heuristica(origem, destino, contexto) : 0.0, 0.0, origem->id)) goto fim;
+
+    tamanho = 0;
+    while (heap.tamanho > 0) {
+        EntradaHeap entrada = retirar_heap(&heap);
+        if (entrada.custo > acumulado[entrada.id]) continue;
+        Antena* atual = grafo->indice[entrada.id];
+        if (atual == destino) {
+            for (int v = destino->id; v >= 0; v = pai[v]) caminho[tamanho++] = grafo->indice[v];
+            for (int a = 0, b = tamanho - 1; a < b; a++, b--) {
+                Antena* troca = caminho[a];
+                caminho[a] = caminho[b];
+                caminho[b] = troca;
+            }
+            if (custo_total) *custo_total = entrada.custo;
+            break;
+        }
+        expandidas++;
+        const int* vizinhos;
+        int grau = vizinhos_antena(grafo, atual, &vizinhos);
+        for (int i = 0; i < grau; i++) {
+            Antena* vizinho = grafo->indice[vizinhos[i]];
+            if (vizinho == atual) continue;
+            double novo = entrada.custo + custo(atual, vizinho, contexto);
+            if (visitas[vizinho->id] == epoca && novo >= acumulado[vizinho->id]) continue;
+            visitas[vizinho->id] = epoca;
+            acumulado[vizinho->id] = novo;
+            pai[vizinho->id] = atual->id;
+            double estimativa = heuristica ? heuristica(vizinho, destino, contexto) : 0.0;
+            if (!inserir_heap(&heap, novo + estimativa, novo, vizinho->id)) {
+                tamanho = -1;
+                goto fim;
+            }
+        }
+    }
+
+fim:
+    ESTATISTICA_SOMAR(grafo, vertices_visitados, expandidas);
+    free(heap.entradas);
+    free(acumulado);
+    free(pai);
+    devolver_contexto_consulta(consulta);
+    return tamanho;
+}
+
+/**
+ * @brief Encontra o caminho de menor custo (Dijkstra com heap binária).
+ */
+int caminho_dijkstra(Grafo* grafo, Antena* origem, Antena* destino, const CustoArestas* custo, Antena** caminho,
+                     double* custo_total) {
+    ESTATISTICA_INICIO(t0);
+    int tamanho = procurar_caminho_ponderado(grafo, origem, destino, custo, false, caminho, custo_total);
+    if (tamanho > 0) ESTATISTICA_SOMAR(grafo, caminhos_emitidos, 1);
+    ESTATISTICA_FIM(grafo, caminho_ponderado, t0);
+    return tamanho;
+}
+
+/**
+ * @brief Encontra o caminho de menor custo com A*.
+ */
+int caminho_a_estrela(Grafo* grafo, Antena* origem, Antena* destino, const CustoArestas* custo, Antena** caminho,
+                      double* custo_total) {
+    ESTATISTICA_INICIO(t0);
+    int tamanho = procurar_caminho_ponderado(grafo, origem, destino, custo, true, caminho, custo_total);
+    if (tamanho > 0) ESTATISTICA_SOMAR(grafo, caminhos_emitidos, 1);
+    ESTATISTICA_FIM(grafo, caminho_ponderado, t0);
+    return tamanho;
+}
+
+/**
+ * @struct EntradaLinha
+ * @brief Antena indexada pela reta (linha, coluna ou diagonal) onde se encontra.
+ */
+typedef struct {
+    long long chave;         /**< Identificador da reta (y, x, x-y ou x+y). */
+    int id;                  /**< Id da antena. */
+} EntradaLinha;
+
+/**
+ * @brief Ordena entradas por reta e, dentro da reta, por id decrescente.
+ */
+int comparar_entradas_linha(const void* a, const void* b) {
+    const EntradaLinha* ea = (const EntradaLinha*)a;
+    const EntradaLinha* eb = (const EntradaLinha*)b;
+    if (ea->chave != eb->chave) return ea->chave < eb->chave ? -1 : 1;
+    return eb->id - ea->id;
+}
+
+/**
+ * @brief Ordena ids por ordem decrescente (ordem da lista de vértices).
+ */
+int comparar_ids_decrescente(const void* a, const void* b) {
+    return *(const int*)b - *(const int*)a;
+}
+
+/**
+ * @brief Identifica a reta de um ponto para um dos quatro tipos de alinhamento.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @param tipo 0 = coluna (x), 1 = linha (y), 2 = diagonal (x-y), 3 = antidiagonal (x+y).
+ * @return Chave da reta.
+ */
+long long chave_linha(int x, int y, int tipo) {
+    switch (tipo) {
+        case 0: return x;
+        case 1: return y;
+        case 2: return (long long)x - y;
+        default: return (long long)x + y;
+    }
+}
+
+/**
+ * @brief Quadrado da distância de um ponto à origem, em aritmética inteira.
+ */
+unsigned long long norma_quadrada(int x, int y) {
+    long long lx = x, ly = y;
+    return (unsigned long long)(lx * lx) + (unsigned long long)(ly * ly);
+}
+
+/**
+ * @brief Conta as antenas de uma frequência no vetor de frequências.
+ *
+ * Com SSE2 compara 16 frequências de cada vez.
+ * @param frequencias Frequência de cada antena, por id.
+ * @param n Número de antenas.
+ * @param frequencia Frequência a contar.
+ * @return Número de antenas com essa frequência.
+ */
+int contar_frequencia(const char* frequencias, int n, char frequencia) {
+    int total = 0;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i alvo = _mm_set1_epi8(frequencia);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bloco = _mm_loadu_si128((const __m128i*)(frequencias + i));
+        total += __builtin_popcount((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bloco, alvo)));
+    }
+#endif
+    for (; i < n; i++) {
+        if (frequencias[i] == frequencia) total++;
+    }
+    return total;
+}
+
+/**
+ * @brief Recolhe, por ordem crescente, os ids das antenas de uma frequência.
+ *
+ * Com SSE2 compara 16 frequências de cada vez e os bits da máscara
+ * resultante dão diretamente os ids, como em colunas_com_frequencia.
+ * @param frequencias Frequência de cada antena, por id.
+ * @param n Número de antenas.
+ * @param frequencia Frequência a procurar.
+ * @param ids Destino, com espaço para contar_frequencia(...) ids.
+ * @return Número de ids escritos.
+ */
+int recolher_frequencia(const char* frequencias, int n, char frequencia, int* ids) {
+    int total = 0;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i alvo = _mm_set1_epi8(frequencia);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bloco = _mm_loadu_si128((const __m128i*)(frequencias + i));
+        unsigned int mascara = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bloco, alvo));
+        while (mascara) {
+            ids[total++] = i + __builtin_ctz(mascara);
+            mascara &= mascara - 1;
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (frequencias[i] == frequencia) ids[total++] = i;
+    }
+    return total;
+}
+
+/**
+ * @brief Lista interseções entre antenas de diferentes frequências.
+ *
+ * As antenas de @p freqB são indexadas por coluna, linha, diagonal e
+ * antidiagonal, pelo que para cada antena de @p freqA só são comparadas as
+ * candidatas colineares. A condição de distância (uma antena ao dobro da
+ * distância da outra em relação à origem) é verificada de forma exata com
+ * os quadrados das distâncias: |a|² == 4·|b|² ou |b|² == 4·|a|².
+ * O vetor de frequências é percorrido só duas vezes, com
+ * recolher_frequencia, uma para cada frequência.
+ * Os pares são reportados pela mesma ordem da pesquisa exaustiva.
+ */
+void listar_intersecoes(Grafo* grafo, char freqA, char freqB, void (*callback)(Antena*, Antena*)) {
+    ESTATISTICA_INICIO(t0);
+    const char* frequencias = grafo->frequencias;
+    const int* xs = grafo->xs;
+    const int* ys = grafo->ys;
+    int num_a = contar_frequencia(frequencias, grafo->num_vertices, freqA);
+    int num_b = contar_frequencia(frequencias, grafo->num_vertices, freqB);
+    if (num_a == 0 || num_b == 0) {
+        ESTATISTICA_FIM(grafo, intersecoes, t0);
+        return;
+    }
+
+    EntradaLinha* linhas[4];
+    int* ids_a = (int*)malloc(num_a * sizeof(int));
+    int* candidatos = (int*)malloc(num_b * sizeof(int));
+    for (int t = 0; t < 4; t++) {
+        linhas[t] = (EntradaLinha*)malloc(num_b * sizeof(EntradaLinha));
+    }
+    if (!ids_a || !candidatos || !linhas[0] || !linhas[1] || !linhas[2] || !linhas[3]) {
+        free(ids_a);
+        free(candidatos);
+        for (int t = 0; t < 4; t++) free(linhas[t]);
+        return;
+    }
+
+    // Os ids de freqB ficam temporariamente em candidatos.
+    recolher_frequencia(frequencias, grafo->num_vertices, freqB, candidatos);
+    for (int k = 0; k < num_b; k++) {
+        int i = candidatos[k];
+        for (int t = 0; t < 4; t++) {
+            linhas[t][k].chave = chave_linha(xs[i], ys[i], t);
+            linhas[t][k].id = i;
+        }
+    }
+    for (int t = 0; t < 4; t++) {
+        qsort(linhas[t], num_b, sizeof(EntradaLinha), comparar_entradas_linha);
+    }
+
+    // Por id decrescente, a ordem da lista de vértices.
+    recolher_frequencia(frequencias, grafo->num_vertices, freqA, ids_a);
+    for (int j = num_a - 1; j >= 0; j--) {
+        int a = ids_a[j];
+        unsigned long long norma_a = norma_quadrada(xs[a], ys[a]);
+        int num_candidatos = 0;
+        for (int t = 0; t < 4; t++) {
+            long long chave = chave_linha(xs[a], ys[a], t);
+            int esq = 0, dir = num_b;
+            while (esq < dir) {
+                int meio = esq + (dir - esq) / 2;
+                if (linhas[t][meio].chave < chave) esq = meio + 1;
+                else dir = meio;
+            }
+            for (int k = esq; k < num_b && linhas[t][k].chave == chave; k++) {
+                int b = linhas[t][k].id;
+                // Duas retas distintas só se cruzam no próprio ponto de a.
+                if (t > 0 && xs[b] == xs[a] && ys[b] == ys[a]) continue;
+                unsigned long long norma_b = norma_quadrada(xs[b], ys[b]);
+                if ((norma_a % 4 == 0 && norma_a / 4 == norma_b) ||
+                    (norma_b % 4 == 0 && norma_b / 4 == norma_a)) {
+                    candidatos[num_candidatos++] = linhas[t][k].id;
+                }
+            }
+        }
+        qsort(candidatos, num_candidatos, sizeof(int), comparar_ids_decrescente);
+        for (int k = 0; k < num_candidatos; k++) {
+            callback(grafo->indice[a], grafo->indice[candidatos[k]]);
+        }
+        ESTATISTICA_SOMAR(grafo, intersecoes_emitidas, num_candidatos);
+    }
+
+    free(ids_a);
+    free(candidatos);
+    for (int t = 0; t < 4; t++) free(linhas[t]);
+    ESTATISTICA_FIM(grafo, intersecoes, t0);
+}
+
+/**
+ * @struct EntradaReta
+ * @brief Antena indexada pela reta onde se encontra e pela distância à origem.
+ */
+typedef struct {
+    long long chave;          /**< Identificador da reta (ver chave_linha). */
+    unsigned long long norma; /**< Quadrado da distância à origem. */
+    int id;                   /**< Id da antena. */
+} EntradaReta;
+
+/**
+ * @struct ParIntersecao
+ * @brief Par encontrado por listar_todas_intersecoes, com a chave de ordenação final.
+ */
+typedef struct {
+    unsigned int frequencias; /**< Frequência de a nos bits 8..15, de b nos bits 0..7. */
+    int a, b;                 /**< Ids das antenas. */
+} ParIntersecao;
+
+/**
+ * @brief Ordena entradas por reta e, dentro da reta, por norma.
+ */
+int comparar_entradas_reta(const void* a, const void* b) {
+    const EntradaReta* ea = (const EntradaReta*)a;
+    const EntradaReta* eb = (const EntradaReta*)b;
+    if (ea->chave != eb->chave) return ea->chave < eb->chave ? -1 : 1;
+    if (ea->norma != eb->norma) return ea->norma < eb->norma ? -1 : 1;
+    return ea->id - eb->id;
+}
+
+/**
+ * @brief Ordena pares por (freqA, freqB) e depois por ids decrescentes de a e de b.
+ */
+int comparar_pares_intersecao(const void* a, const void* b) {
+    const ParIntersecao* pa = (const ParIntersecao*)a;
+    const ParIntersecao* pb = (const ParIntersecao*)b;
+    if (pa->frequencias != pb->frequencias) return pa->frequencias < pb->frequencias ? -1 : 1;
+    if (pa->a != pb->a) return pb->a - pa->a;
+    return pb->b - pa->b;
+}
+
+/**
+ * @brief Acrescenta à lista local as antenas de uma reta com uma dada norma.
+ * @param grafo Ponteiro para o grafo.
+ * @param entradas Entradas do tipo de reta, ordenadas por comparar_entradas_reta.
+ * @param n Número de entradas.
+ * @param tipo Tipo de reta (0 = coluna, 1..3 = linha e diagonais).
+ * @param a Id da antena de referência.
+ * @param norma Norma procurada.
+ * @param pares Buffer local da thread.
+ * @param tamanho Número de pares no buffer.
+ * @param capacidade Capacidade do buffer.
+ * @return false se não houve memória.
+ */
+bool recolher_intersecoes(Grafo* grafo, const EntradaReta* entradas, int n, int tipo, int a,
+                          unsigned long long norma, ParIntersecao** pares, long long* tamanho, long long* capacidade) {
+    const char* frequencias = grafo->frequencias;
+    const int* xs = grafo->xs;
+    const int* ys = grafo->ys;
+    long long chave = chave_linha(xs[a], ys[a], tipo);
+    int esq = 0, dir = n;
+    while (esq < dir) {
+        int meio = esq + (dir - esq) / 2;
+        const EntradaReta* e = &entradas[meio];
+        if (e->chave < chave || (e->chave == chave && e->norma < norma)) esq = meio + 1;
+        else dir = meio;
+    }
+    for (int k = esq; k < n && entradas[k].chave == chave && entradas[k].norma == norma; k++) {
+        int b = entradas[k].id;
+        if (frequencias[b] == frequencias[a]) continue;
+        // Duas retas distintas só se cruzam no próprio ponto de a.
+        if (tipo > 0 && xs[b] == xs[a] && ys[b] == ys[a]) continue;
+        if (*tamanho == *capacidade) {
+            long long nova_capacidade = *capacidade ? *capacidade * 2 : 1024;
+            ParIntersecao* novo = (ParIntersecao*)realloc(*pares, (size_t)nova_capacidade * sizeof(ParIntersecao));
+            if (!novo) return false;
+            *pares = novo;
+            *capacidade = nova_capacidade;
+        }
+        ParIntersecao* par = &(*pares)[(*tamanho)++];
+        par->frequencias = ((unsigned int)(unsigned char)frequencias[a] << 8) | (unsigned char)frequencias[b];
+        par->a = a;
+        par->b = b;
+    }
+    return true;
+}
+
+/**
+ * @brief Lista as interseções de todos os pares de frequências numa só passagem.
+ *
+ * Todas as antenas são indexadas uma vez por reta e por norma (quatro
+ * vetores ordenados); para cada antena basta procurar, em cada uma das
+ * suas quatro retas, as antenas com norma 4·|a|² ou |a|²/4. As antenas são
+ * repartidas pelas threads em blocos dinâmicos e cada thread acumula os
+ * pares num buffer próprio; no fim os buffers são juntos e ordenados, para
+ * que a saída seja a mesma que chamar listar_intersecoes para cada par
+ * ordenado (freqA, freqB), com freqA != freqB, por ordem crescente.
+ */
+long long listar_todas_intersecoes(Grafo* grafo, void (*callback)(Antena*, Antena*)) {
+    ESTATISTICA_INICIO(t0);
+    int n = grafo->num_vertices;
+    EntradaReta* retas[4] = {NULL, NULL, NULL, NULL};
+    bool ok = true;
+    for (int t = 0; t < 4; t++) {
+        retas[t] = (EntradaReta*)malloc((n > 0 ? n : 1) * sizeof(EntradaReta));
+        ok = ok && retas[t];
+    }
+
+    if (ok) {
+        #pragma omp parallel for schedule(static, 1)
+        for (int t = 0; t < 4; t++) {
+            for (int i = 0; i < n; i++) {
+                retas[t][i].chave = chave_linha(grafo->xs[i], grafo->ys[i], t);
+                retas[t][i].norma = norma_quadrada(grafo->xs[i], grafo->ys[i]);
+                retas[t][i].id = i;
+            }
+            qsort(retas[t], n, sizeof(EntradaReta), comparar_entradas_reta);
+        }
+    }
+
+    int num_threads = omp_get_max_threads();
+    ParIntersecao** buffers = (ParIntersecao**)calloc(num_threads, sizeof(ParIntersecao*));
+    long long* tamanhos = (long long*)calloc(num_threads, sizeof(long long));
+    ok = ok && buffers && tamanhos;
+
+    if (ok) {
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int tid = omp_get_thread_num();
+            long long capacidade = 0;
+            bool ok_local = true;
+            #pragma omp for schedule(dynamic, 256)
+            for (int i = 0; i < n; i++) {
+                if (!ok_local) continue;
+                unsigned long long norma = norma_quadrada(grafo->xs[i], grafo->ys[i]);
+                for (int t = 0; t < 4 && ok_local; t++) {
+                    if (norma % 4 == 0) {
+                        ok_local = recolher_intersecoes(grafo, retas[t], n, t, i, norma / 4, &buffers[tid],
+                                                        &tamanhos[tid], &capacidade);
+                    }
+                    if (ok_local && norma != 0 && norma <= ULLONG_MAX / 4) {
+                        ok_local = recolher_intersecoes(grafo, retas[t], n, t, i, norma * 4, &buffers[tid],
+                                                        &tamanhos[tid], &capacidade);
+                    }
+                }
+            }
+            if (!ok_local) {
+                #pragma omp atomic write
+                ok = false;
+            }
+        }
+    }
+
+    // Junta os buffers das threads e ordena pela ordem de saída.
+    long long total = 0;
+    ParIntersecao* pares = NULL;
+    if (ok) {
+        for (int k = 0; k < num_threads; k++) total += tamanhos[k];
+        pares = (ParIntersecao*)malloc((total > 0 ? total : 1) * sizeof(ParIntersecao));
+        ok = pares != NULL;
+    }
+    if (ok) {
+        long long pos = 0;
+        for (int k = 0; k < num_threads; k++) {
+            if (tamanhos[k] > 0) memcpy(pares + pos, buffers[k], (size_t)tamanhos[k] * sizeof(ParIntersecao));
+            pos += tamanhos[k];
+        }
+        qsort(pares, (size_t)total, sizeof(ParIntersecao), comparar_pares_intersecao);
+        if (callback) {
+            for (long long k = 0; k < total; k++) callback(grafo->indice[pares[k].a], grafo->indice[pares[k].b]);
+        }
+        ESTATISTICA_SOMAR(grafo, intersecoes_emitidas, total);
+    }
+
+    for (int k = 0; buffers && k < num_threads; k++) free(buffers[k]);
+    free(buffers);
+    free(tamanhos);
+    free(pares);
+    for (int t = 0; t < 4; t++) free(retas[t]);
+    ESTATISTICA_FIM(grafo, intersecoes, t0);
+    return ok ? total : -1;
+}
+
+/**
+ * @brief Procura o próximo byte diferente de '.' a partir de uma posição.
+ *
+ * Com SSE2 compara 16 bytes de cada vez, pelo que as zonas vazias do mapa
+ * são saltadas sem examinar byte a byte.
+ * @param dados Texto do mapa.
+ * @param pos Posição inicial.
+ * @param tamanho Tamanho do texto.
+ * @return Posição encontrada, ou @p tamanho se não houver.
+ */
+size_t proximo_nao_ponto(const char* dados, size_t pos, size_t tamanho) {
+#if defined(__SSE2__)
+    const __m128i pontos = _mm_set1_epi8('.');
+    while (pos + 16 <= tamanho) {
+        __m128i bloco = _mm_loadu_si128((const __m128i*)(dados + pos));
+        int mascara = _mm_movemask_epi8(_mm_cmpeq_epi8(bloco, pontos)) ^ 0xFFFF;
+        if (mascara) return pos + (size_t)__builtin_ctz((unsigned int)mascara);
+        pos += 16;
+    }
+#endif
+    while (pos < tamanho && dados[pos] == '.') pos++;
+    return pos;
+}
+
+/**
+ * @brief Percorre um troço do texto do mapa, contando (e opcionalmente guardando) antenas.
+ *
+ * O troço tem de começar no início de uma linha. As linhas podem ter
+ * qualquer largura; terminações "\r\n" são aceites.
+ * @param dados Texto do troço.
+ * @param tamanho Tamanho do troço.
+ * @param y0 Linha do mapa onde o troço começa.
+ * @param frequencias Recebe a frequência de cada antena, ou NULL para apenas contar.
+ * @param xs Recebe a coordenada X de cada antena (ignorado se @p frequencias é NULL).
+ * @param ys Recebe a coordenada Y de cada antena (ignorado se @p frequencias é NULL).
+ * @param linhas Recebe o número de linhas do troço.
+ * @param colunas Recebe a largura da linha mais longa.
+ * @return Número de antenas encontradas.
+ */
+long long percorrer_mapa_texto(const char* dados, size_t tamanho, int y0, char* frequencias, int* xs, int* ys,
+                               int* linhas, int* colunas) {
+    long long total = 0;
+    size_t inicio_linha = 0;
+    int y = 0;
+    *colunas = 0;
+
+    size_t pos = proximo_nao_ponto(dados, 0, tamanho);
+    while (pos < tamanho) {
+        char c = dados[pos];
+        if (c == '\n') {
+            size_t largura = pos - inicio_linha;
+            if (largura > 0 && dados[pos - 1] == '\r') largura--;
+            if ((int)largura > *colunas) *colunas = (int)largura;
+            inicio_linha = pos + 1;
+            y++;
+        } else if (c != '\r') {
+            if (frequencias) {
+                frequencias[total] = c;
+                xs[total] = (int)(pos - inicio_linha);
+                ys[total] = y0 + y;
+            }
+            total++;
+        }
+        pos = proximo_nao_ponto(dados, pos + 1, tamanho);
+    }
+    if (inicio_linha < tamanho) {
+        size_t largura = tamanho - inicio_linha;
+        if (dados[tamanho - 1] == '\r') largura--;
+        if ((int)largura > *colunas) *colunas = (int)largura;
+        y++;
+    }
+
+    *linhas = y;
+    return total;
+}
+
+#define TROCO_MAPA_MIN (1u << 20) /**< Tamanho mínimo de cada troço do carregamento paralelo. */
+
+/**
+ * @brief Carrega o grafo de um ficheiro de texto.
+ *
+ * O ficheiro é mapeado em memória e dividido em troços que acabam em fins
+ * de linha, percorridos em paralelo (OpenMP) duas vezes: a primeira conta as
+ * antenas e as linhas de cada troço, o que dá por somas prefixas o primeiro
+ * id e a primeira linha de cada um; a segunda escreve as antenas de cada
+ * troço diretamente na sua posição final dos vetores de atributos do grafo.
+ * Os nós são depois criados por ordem, pelo que os ids são os mesmos de um
+ * carregamento sequencial. As
+ * dimensões detetadas ficam em grafo->linhas e grafo->colunas.
+ */
+Grafo* carregar_grafo_arquivo(const char* filename) {
+    ESTATISTICA_INICIO(t0);
+    FicheiroMapeado ficheiro;
+    if (!mapear_ficheiro(filename, &ficheiro, false)) return NULL;
+    const char* dados = ficheiro.dados;
+    size_t tamanho = ficheiro.tamanho;
+
+    int num_trocos = (int)(tamanho / TROCO_MAPA_MIN) + 1;
+    if (num_trocos > omp_get_max_threads() * 4) num_trocos = omp_get_max_threads() * 4;
+    size_t* limites = (size_t*)malloc((num_trocos + 1) * sizeof(size_t));
+    long long* primeiro_id = (long long*)malloc((num_trocos + 1) * sizeof(long long));
+    int* primeira_linha = (int*)malloc((num_trocos + 1) * sizeof(int));
+    int* larguras = (int*)malloc(num_trocos * sizeof(int));
+    Grafo* grafo = NULL;
+    if (!limites || !primeiro_id || !primeira_linha || !larguras) goto fim;
+
+    // Cada troço começa logo a seguir a um '\n' (troços vazios são possíveis).
+    limites[0] = 0;
+    for (int k = 1; k < num_trocos; k++) {
+        size_t pos = tamanho / num_trocos * k;
+        if (pos < limites[k - 1]) pos = limites[k - 1];
+        const char* fim_linha = pos < tamanho ? (const char*)memchr(dados + pos, '\n', tamanho - pos) : NULL;
+        limites[k] = fim_linha ? (size_t)(fim_linha - dados) + 1 : tamanho;
+    }
+    limites[num_trocos] = tamanho;
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int k = 0; k < num_trocos; k++) {
+        primeiro_id[k + 1] = percorrer_mapa_texto(dados + limites[k], limites[k + 1] - limites[k], 0, NULL, NULL, NULL,
+                                                  &primeira_linha[k + 1], &larguras[k]);
+    }
+
+    int colunas = 0;
+    primeiro_id[0] = 0;
+    primeira_linha[0] = 0;
+    for (int k = 0; k < num_trocos; k++) {
+        primeiro_id[k + 1] += primeiro_id[k];
+        primeira_linha[k + 1] += primeira_linha[k];
+        if (larguras[k] > colunas) colunas = larguras[k];
+    }
+    long long total = primeiro_id[num_trocos];
+    if (total > 0x7fffffff) goto fim;
+
+    grafo = criar_grafo();
+    if (!reservar_antenas(grafo, (int)total)) {
+        destruir_grafo(grafo);
+        grafo = NULL;
+        goto fim;
+    }
+
+    // Cada troço escreve as suas antenas diretamente nos vetores de atributos
+    // do grafo (que só existem se houver antenas).
+    int trocos_a_ler = total > 0 ? num_trocos : 0;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int k = 0; k < trocos_a_ler; k++) {
+        int linhas_troco, largura;
+        long long id = primeiro_id[k];
+        percorrer_mapa_texto(dados + limites[k], limites[k + 1] - limites[k], primeira_linha[k], grafo->frequencias + id,
+                             grafo->xs + id, grafo->ys + id, &linhas_troco, &largura);
+    }
+
+    for (long long i = 0; i < total; i++) {
+        indexar_coordenadas(grafo, alocar_no_antena(grafo, grafo->frequencias[i], grafo->xs[i], grafo->ys[i]));
+    }
+    grafo->linhas = primeira_linha[num_trocos];
+    grafo->colunas = colunas;
+    conectar_antenas(grafo);
+    ESTATISTICA_FIM(grafo, carregar_texto, t0);
+
+fim:
+    desmapear_ficheiro(&ficheiro);
+    free(limites);
+    free(primeiro_id);
+    free(primeira_linha);
+    free(larguras);
+    return grafo;
+}
+
+#define LIMITE_BANDA_MATRIZ (8u << 20) /**< Bytes de saída gerados de cada vez. */
+
+/**
+ * @brief Devolve a representação binária ("bbbbbbbb ") de cada byte.
+ */
+const char (*tabela_binario(void))[9] {
+    static char tabela[256][9];
+    static bool iniciada = false;
+    if (!iniciada) {
+        for (int c = 0; c < 256; c++) {
+            for (int b = 7; b >= 0; b--) tabela[c][7 - b] = (char)('0' + ((c >> b) & 1));
+            tabela[c][8] = ' ';
+        }
+        iniciada = true;
+    }
+    return (const char (*)[9])tabela;
+}
+
+/**
+ * @brief Escreve uma célula da matriz num buffer de saída.
+ */
+void escrever_celula(char* destino, unsigned char c, bool binario) {
+    if (binario) memcpy(destino, tabela_binario()[c], 9);
+    else *destino = (char)c;
+}
+
+/**
+ * @brief Escreve as antenas de uma linha da grelha densa num buffer de saída.
+ *
+ * Só as palavras não nulas do bitmap são examinadas, pelo que blocos de 64
+ * células livres custam uma única comparação.
+ */
+void renderizar_linha_grelha(Grafo* grafo, int y, int colunas, char* linha, size_t largura_celula, bool binario) {
+    GrelhaDensa* g = &grafo->grelha;
+    if (y >= g->linhas) return;
+    if (colunas > g->colunas) colunas = g->colunas;
+    const uint64_t* palavras = g->ocupacao + (size_t)y * g->palavras_linha;
+    const unsigned char* frequencias = g->frequencias + (size_t)y * g->colunas;
+    for (int w = 0; w * 64 < colunas; w++) {
+        uint64_t bits = palavras[w];
+        while (bits) {
+            int x = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (x >= colunas) break;
+            escrever_celula(linha + (size_t)x * largura_celula, frequencias[x], binario);
+        }
+    }
+}
+
+/**
+ * @brief Imprime a matriz de antenas em texto ou em binário.
+ *
+ * Sem a grelha densa, as antenas são primeiro agrupadas por linha (counting
+ * sort). A saída é gerada em bandas de linhas num buffer contíguo, escrito
+ * com um único fwrite por banda. Dimensões não positivas usam as do grafo.
+ */
+void renderizar_matriz(Grafo* grafo, int linhas, int colunas, bool binario) {
+    if (linhas <= 0) linhas = grafo->linhas;
+    if (colunas <= 0) colunas = grafo->colunas;
+    if (linhas <= 0) return;
+
+    bool grelha = grafo->grelha.frequencias != NULL;
+    int* inicio_linha = NULL;
+    int* ids = NULL;
+    size_t largura_celula = binario ? 9 : 1;
+    size_t bytes_linha = (size_t)colunas * largura_celula + 1;
+    size_t linhas_banda = LIMITE_BANDA_MATRIZ / bytes_linha;
+    if (linhas_banda == 0) linhas_banda = 1;
+    if (linhas_banda > (size_t)linhas) linhas_banda = (size_t)linhas;
+    char* prototipo = (char*)malloc(bytes_linha);
+    char* buffer = (char*)malloc(bytes_linha * linhas_banda);
+    if (!grelha) {
+        inicio_linha = (int*)calloc((size_t)linhas + 1, sizeof(int));
+        ids = (int*)malloc((grafo->num_vertices > 0 ? grafo->num_vertices : 1) * sizeof(int));
+    }
+    if (!prototipo || !buffer || (!grelha && (!inicio_linha || !ids))) {
+        free(inicio_linha);
+        free(ids);
+        free(prototipo);
+        free(buffer);
+        return;
+    }
+
+    if (!grelha) {
+        // Ids das antenas de cada linha, por id decrescente (a mais antiga fica por cima).
+        const int* xs = grafo->xs;
+        const int* ys = grafo->ys;
+        for (int i = 0; i < grafo->num_vertices; i++) {
+            if (ys[i] >= 0 && ys[i] < linhas && xs[i] >= 0 && xs[i] < colunas) inicio_linha[ys[i] + 1]++;
+        }
+        for (int y = 0; y < linhas; y++) inicio_linha[y + 1] += inicio_linha[y];
+        for (int i = grafo->num_vertices - 1; i >= 0; i--) {
+            if (ys[i] >= 0 && ys[i] < linhas && xs[i] >= 0 && xs[i] < colunas) ids[inicio_linha[ys[i]]++] = i;
+        }
+        for (int y = linhas; y > 0; y--) inicio_linha[y] = inicio_linha[y - 1];
+        inicio_linha[0] = 0;
+    }
+
+    for (int x = 0; x < colunas; x++) escrever_celula(prototipo + (size_t)x * largura_celula, '.', binario);
+    prototipo[bytes_linha - 1] = '\n';
+
+    for (int banda = 0; banda < linhas; banda += (int)linhas_banda) {
+        int fim = banda + (int)linhas_banda < linhas ? banda + (int)linhas_banda : linhas;
+        for (int y = banda; y < fim; y++) {
+            char* linha = buffer + (size_t)(y - banda) * bytes_linha;
+            memcpy(linha, prototipo, bytes_linha);
+            if (grelha) {
+                renderizar_linha_grelha(grafo, y, colunas, linha, largura_celula, binario);
+                continue;
+            }
+            for (int k = inicio_linha[y]; k < inicio_linha[y + 1]; k++) {
+                escrever_celula(linha + (size_t)grafo->xs[ids[k]] * largura_celula,
+                                (unsigned char)grafo->frequencias[ids[k]], binario);
+            }
+        }
+        fwrite(buffer, 1, (size_t)(fim - banda) * bytes_linha, stdout);
+    }
+    fflush(stdout);
+
+    free(inicio_linha);
+    free(ids);
+    free(prototipo);
+    free(buffer);
+}
+
+/**
+ * @brief Imprime a matriz no formato de texto.
+ */
+void imprimir_matriz(Grafo* grafo, int linhas, int colunas) {
+    renderizar_matriz(grafo, linhas, colunas, false);
+}
+
+/**
+ * @brief Obtém a frequência de uma célula da grelha densa.
+ */
+char frequencia_celula(Grafo* grafo, int x, int y) {
+    GrelhaDensa* g = &grafo->grelha;
+    if (!g->frequencias || x < 0 || y < 0 || x >= g->colunas || y >= g->linhas) return '\0';
+    return (char)g->frequencias[(size_t)y * g->colunas + x];
+}
+
+/**
+ * @brief Lista as colunas de uma linha ocupadas por uma frequência.
+ *
+ * Cada bloco de 16 células é comparado de uma vez com a frequência e os
+ * bits da máscara resultante dão diretamente as colunas.
+ */
+int colunas_com_frequencia(Grafo* grafo, char frequencia, int y, int* colunas) {
+    GrelhaDensa* g = &grafo->grelha;
+    if (!g->frequencias || frequencia == '\0' || y < 0 || y >= g->linhas) return 0;
+    const unsigned char* linha = g->frequencias + (size_t)y * g->colunas;
+    int n = 0, x = 0;
+#if defined(__SSE2__)
+    const __m128i alvo = _mm_set1_epi8(frequencia);
+    for (; x + 16 <= g->colunas; x += 16) {
+        __m128i bloco = _mm_loadu_si128((const __m128i*)(linha + x));
+        unsigned int mascara = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bloco, alvo));
+        while (mascara) {
+            colunas[n++] = x + __builtin_ctz(mascara);
+            mascara &= mascara - 1;
+        }
+    }
+#endif
+    for (; x < g->colunas; x++) {
+        if (linha[x] == (unsigned char)frequencia) colunas[n++] = x;
+    }
+    return n;
+}
+
+/**
+ * @brief Encontra uma antena pelas suas coordenadas.
+ */
+Antena* encontrar_antena(Grafo* grafo, int x, int y) {
+    if (!grafo->tabela_coordenadas) return NULL;
+    // Com a grelha densa, uma célula livre dispensa a pesquisa na tabela.
+    GrelhaDensa* g = &grafo->grelha;
+    if (g->frequencias && x >= 0 && y >= 0) {
+        if (x >= g->colunas || y >= g->linhas) return NULL;
+        if (!(g->ocupacao[(size_t)y * g->palavras_linha + (x >> 6)] >> (x & 63) & 1)) return NULL;
+    }
+    int mascara = grafo->capacidade_coordenadas - 1;
+    int pos = hash_coordenadas(x, y, mascara);
+    ESTATISTICA_SOMAR(grafo, sondagens_coordenadas, 1);
+    while (grafo->tabela_coordenadas[pos] >= 0) {
+        int id = grafo->tabela_coordenadas[pos];
+        if (grafo->xs[id] == x && grafo->ys[id] == y) {
+            return grafo->indice[id];
+        }
+        pos = (pos + 1) & mascara;
+        ESTATISTICA_SOMAR(grafo, sondagens_coordenadas, 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Arredonda um offset para o alinhamento das secções do formato binário.
+ */
+uint64_t alinhar_offset(uint64_t offset) {
+    return (offset + GRAFO_BINARIO_ALINHAMENTO - 1) & ~(uint64_t)(GRAFO_BINARIO_ALINHAMENTO - 1);
+}
+
+/**
+ * @brief Escreve o padding até ao início de uma secção do formato binário.
+ * @return false em caso de erro de escrita.
+ */
+bool iniciar_secao(FILE* file, uint64_t* posicao, uint64_t offset) {
+    static const char zeros[GRAFO_BINARIO_ALINHAMENTO] = {0};
+    if (fwrite(zeros, 1, (size_t)(offset - *posicao), file) != offset - *posicao) return false;
+    *posicao = offset;
+    return true;
+}
+
+/**
+ * @brief Escreve dados na posição atual do ficheiro binário.
+ * @return false em caso de erro de escrita.
+ */
+bool escrever_dados(FILE* file, uint64_t* posicao, const void* dados, size_t tamanho) {
+    if (tamanho > 0 && fwrite(dados, 1, tamanho, file) != tamanho) return false;
+    *posicao += tamanho;
+    return true;
+}
+
+/**
+ * @brief Escreve uma secção do formato binário no seu offset (com padding).
+ * @return false em caso de erro de escrita.
+ */
+bool escrever_secao(FILE* file, uint64_t* posicao, uint64_t offset, const void* dados, size_t tamanho) {
+    if (offset == 0) return true;
+    return iniciar_secao(file, posicao, offset) && escrever_dados(file, posicao, dados, tamanho);
+}
+
+/**
+ * @brief Guarda o grafo num ficheiro binário.
+ *
+ * Escreve o cabeçalho (ver CabecalhoBinario) seguido das secções alinhadas:
+ * frequências, coordenadas, buckets de frequência, tabela de coordenadas e,
+ * se materializada, a CSR. Os atributos e a tabela de coordenadas são
+ * escritos com um único fwrite, diretamente a partir dos vetores; os buckets
+ * e as linhas CSR, que podem estar em blocos separados, são escritos por
+ * frequência e por antena, de forma a formarem no ficheiro vetores contíguos.
+ */
+bool salvar_grafo_binario(Grafo* grafo, const char* filename) {
+    ESTATISTICA_INICIO(t0);
+    int n = grafo->num_vertices;
+    bool com_buckets = grafo->membros && grafo->num_vertices_ligados == n;
+    // Os offsets da CSR no ficheiro são int32.
+    bool com_csr = com_buckets && grafo->inicio_arestas && grafo->num_arestas <= INT32_MAX;
+    int32_t inicio_membros[257];
+    inicio_membros[0] = 0;
+    for (int f = 0; f < 256; f++) inicio_membros[f + 1] = inicio_membros[f] + grafo->tamanho_frequencia[f];
+
+    CabecalhoBinario cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magia, GRAFO_BINARIO_MAGIA, sizeof(cab.magia));
+    cab.versao = GRAFO_BINARIO_VERSAO;
+    cab.endianness = GRAFO_BINARIO_ENDIANNESS;
+    cab.linhas = grafo->linhas;
+    cab.colunas = grafo->colunas;
+    cab.num_vertices = n;
+    cab.capacidade_coordenadas = grafo->capacidade_coordenadas;
+    cab.num_arestas = grafo->num_arestas;
+    cab.num_destinos = com_csr ? grafo->num_arestas : 0;
+
+    // As secções vazias ficam com offset 0, tal como as ausentes.
+    uint64_t fim = alinhar_offset(sizeof(CabecalhoBinario));
+    if (n > 0) {
+        cab.off_frequencias = fim;
+        fim = alinhar_offset(fim + (uint64_t)n);
+        cab.off_x = fim;
+        fim = alinhar_offset(fim + (uint64_t)n * sizeof(int32_t));
+        cab.off_y = fim;
+        fim = alinhar_offset(fim + (uint64_t)n * sizeof(int32_t));
+    }
+    if (grafo->capacidade_coordenadas > 0) {
+        cab.off_coordenadas = fim;
+        fim = alinhar_offset(fim + (uint64_t)grafo->capacidade_coordenadas * sizeof(int32_t));
+    }
+    if (com_buckets) {
+        cab.off_inicio_membros = fim;
+        fim = alinhar_offset(fim + 257 * sizeof(int32_t));
+        if (n > 0) {
+            cab.off_membros = fim;
+            fim = alinhar_offset(fim + (uint64_t)n * sizeof(int32_t));
+        }
+    }
+    if (com_csr) {
+        cab.off_inicio_arestas = fim;
+        fim = alinhar_offset(fim + (uint64_t)(n + 1) * sizeof(int32_t));
+        if (cab.num_destinos > 0) cab.off_destinos = fim;
+    }
+
+    FILE* file = fopen(filename, "wb");
+    bool ok = file != NULL;
+    uint64_t posicao = 0;
+    ok = ok && fwrite(&cab, sizeof(cab), 1, file) == 1;
+    posicao = sizeof(cab);
+    ok = ok && escrever_secao(file, &posicao, cab.off_frequencias, grafo->frequencias, (size_t)n);
+    ok = ok && escrever_secao(file, &posicao, cab.off_x, grafo->xs, (size_t)n * sizeof(int32_t));
+    ok = ok && escrever_secao(file, &posicao, cab.off_y, grafo->ys, (size_t)n * sizeof(int32_t));
+    ok = ok && escrever_secao(file, &posicao, cab.off_coordenadas, grafo->tabela_coordenadas,
+                              (size_t)grafo->capacidade_coordenadas * sizeof(int32_t));
+    ok = ok && escrever_secao(file, &posicao, cab.off_inicio_membros, inicio_membros, sizeof(inicio_membros));
+    if (ok && cab.off_membros) {
+        ok = iniciar_secao(file, &posicao, cab.off_membros);
+        for (int f = 0; ok && f < 256; f++) {
+            ok = escrever_dados(file, &posicao, grafo->membros_frequencia[f],
+                                (size_t)grafo->tamanho_frequencia[f] * sizeof(int32_t));
+        }
+    }
+    if (ok && cab.off_inicio_arestas) {
+        // No ficheiro as linhas ficam lado a lado, por ordem de id.
+        int32_t offsets[1024];
+        int usados = 0;
+        int32_t offset = 0;
+        ok = iniciar_secao(file, &posicao, cab.off_inicio_arestas);
+        for (int i = 0; ok && i <= n; i++) {
+            offsets[usados++] = offset;
+            if (i < n) offset += grafo->tamanho_frequencia[(unsigned char)grafo->frequencias[i]] - 1;
+            if (usados == 1024 || i == n) {
+                ok = escrever_dados(file, &posicao, offsets, (size_t)usados * sizeof(int32_t));
+                usados = 0;
+            }
+        }
+    }
+    if (ok && cab.off_destinos) {
+        ok = iniciar_secao(file, &posicao, cab.off_destinos);
+        for (int i = 0; ok && i < n; i++) {
+            const int* vizinhos;
+            int grau = vizinhos_antena(grafo, grafo->indice[i], &vizinhos);
+            ok = escrever_dados(file, &posicao, vizinhos, (size_t)grau * sizeof(int32_t));
+        }
+    }
+    if (file && fclose(file) != 0) ok = false;
+    ESTATISTICA_FIM(grafo, salvar_binario, t0);
+    return ok;
+}
+
+/**
+ * @brief Verifica se uma secção do ficheiro binário cabe no ficheiro.
+ */
+bool secao_valida(const FicheiroMapeado* ficheiro, uint64_t offset, uint64_t tamanho) {
+    if (offset == 0) return true;
+    return offset % GRAFO_BINARIO_ALINHAMENTO == 0 && offset <= ficheiro->tamanho &&
+           tamanho <= ficheiro->tamanho - offset;
+}
+
+/**
+ * @brief Devolve o início de uma secção do ficheiro binário.
+ * @return Ponteiro para a secção, ou NULL se estiver ausente ou vazia.
+ */
+void* secao_binaria(const FicheiroMapeado* ficheiro, uint64_t offset, uint64_t tamanho) {
+    return offset && tamanho ? ficheiro->dados + offset : NULL;
+}
+
+/**
+ * @brief Verifica se todos os ids de um vetor do ficheiro binário estão em [minimo, n).
+ * @param ids Vetor de ids (pode ser NULL se @p tamanho é 0).
+ * @param tamanho Número de entradas.
+ * @param minimo Menor valor aceite (-1 para aceitar posições livres).
+ * @param n Número de antenas.
+ */
+bool ids_validos(const int32_t* ids, int64_t tamanho, int32_t minimo, int32_t n) {
+    for (int64_t i = 0; i < tamanho; i++) {
+        if (ids[i] < minimo || ids[i] >= n) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Verifica os buckets de frequência de um ficheiro binário.
+ *
+ * Os offsets têm de ser crescentes e cobrir os @p n ids, e cada bucket tem
+ * de conter, por ordem crescente, ids da sua frequência.
+ */
+bool buckets_validos(const int32_t* inicio_membros, const int32_t* membros, const char* frequencias, int32_t n) {
+    if (inicio_membros[0] != 0 || inicio_membros[256] != n) return false;
+    for (int f = 0; f < 256; f++) {
+        if (inicio_membros[f] > inicio_membros[f + 1]) return false;
+        for (int32_t k = inicio_membros[f]; k < inicio_membros[f + 1]; k++) {
+            if (membros[k] < 0 || membros[k] >= n || (unsigned char)frequencias[membros[k]] != f) return false;
+            if (k > inicio_membros[f] && membros[k] <= membros[k - 1]) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Verifica a CSR de um ficheiro binário.
+ *
+ * Os offsets têm de ser crescentes até @p num_destinos, cada linha tem de ter
+ * o tamanho do bucket da antena menos um (o comprimento das linhas é obtido
+ * dos buckets) e os ids têm de estar em [0, n).
+ */
+bool csr_valida(const int32_t* inicio, const int32_t* destinos, int64_t num_destinos, int32_t n,
+                const int32_t* inicio_membros, const char* frequencias) {
+    if (inicio[0] != 0 || inicio[n] != num_destinos) return false;
+    for (int32_t i = 0; i < n; i++) {
+        unsigned char f = (unsigned char)frequencias[i];
+        if (inicio[i + 1] - (int64_t)inicio[i] != inicio_membros[f + 1] - (int64_t)inicio_membros[f] - 1) return false;
+    }
+    return ids_validos(destinos, num_destinos, 0, n);
+}
+
+/**
+ * @brief Reconstrói as cadeias de antenas sobrepostas a partir da tabela de coordenadas.
+ *
+ * A tabela vinda do ficheiro binário só guarda a antena mais recente de
+ * cada célula. Verifica também que a tabela corresponde às antenas: cada
+ * antena tem de encontrar a sua célula por sondagem a partir do hash, e
+ * cada posição ocupada tem de guardar o maior id dessa célula.
+ * @param grafo Ponteiro para o grafo (com a tabela e @c seguinte_celula).
+ * @return false se a tabela não é coerente ou se não houve memória.
+ */
+bool ligar_celulas(Grafo* grafo) {
+    int capacidade = grafo->capacidade_coordenadas;
+    int mascara = capacidade - 1;
+    const int* tabela = grafo->tabela_coordenadas;
+    int* ultima = (int*)malloc(capacidade * sizeof(int));
+    if (!ultima) return false;
+    memset(ultima, -1, capacidade * sizeof(int));
+
+    bool valida = true;
+    for (int i = 0; valida && i < grafo->num_vertices; i++) {
+        int x = grafo->xs[i], y = grafo->ys[i];
+        int pos = hash_coordenadas(x, y, mascara);
+        int passos = 0;
+        while (passos < capacidade && tabela[pos] >= 0 && (grafo->xs[tabela[pos]] != x || grafo->ys[tabela[pos]] != y)) {
+            pos = (pos + 1) & mascara;
+            passos++;
+        }
+        valida = passos < capacidade && tabela[pos] >= 0;
+        if (valida) {
+            grafo->seguinte_celula[i] = ultima[pos];
+            ultima[pos] = i;
+        }
+    }
+    grafo->num_coordenadas = 0;
+    for (int pos = 0; valida && pos < capacidade; pos++) {
+        if (tabela[pos] < 0) continue;
+        valida = ultima[pos] == tabela[pos];
+        grafo->num_coordenadas++;
+    }
+    free(ultima);
+    return valida;
+}
+
+/**
+ * @brief Carrega um ficheiro no formato antigo (num_vertices + registos freq,x,y).
+ */
+Grafo* carregar_grafo_binario_legado(const FicheiroMapeado* ficheiro) {
+    const size_t registo = sizeof(char) + 2 * sizeof(int);
+    int num_vertices;
+    if (ficheiro->tamanho < sizeof(int)) return NULL;
+    memcpy(&num_vertices, ficheiro->dados, sizeof(int));
+    if (num_vertices < 0 || (ficheiro->tamanho - sizeof(int)) / registo < (size_t)num_vertices) return NULL;
+
+    Grafo* grafo = criar_grafo();
+    if (!reservar_antenas(grafo, num_vertices)) {
+        destruir_grafo(grafo);
+        return NULL;
+    }
+    const char* p = ficheiro->dados + sizeof(int);
+    for (int i = 0; i < num_vertices; i++, p += registo) {
+        char freq;
+        int x, y;
+        memcpy(&freq, p, sizeof(char));
+        memcpy(&x, p + sizeof(char), sizeof(int));
+        memcpy(&y, p + sizeof(char) + sizeof(int), sizeof(int));
+        adicionar_antena(grafo, freq, x, y);
+    }
+    conectar_antenas(grafo);
+    return grafo;
+}
+
+/**
+ * @brief Carrega o grafo de um ficheiro binário.
+ *
+ * O ficheiro é mapeado em memória e o grafo passa a usar diretamente os
+ * vetores do ficheiro (atributos das antenas, buckets de frequência, tabela
+ * de coordenadas e CSR): nada é reconstruído, apenas são criados os nós das
+ * antenas, todos num só bloco da arena. Antes disso todos os ids das tabelas
+ * são validados, pelo que um ficheiro inconsistente é rejeitado. Ficheiros
+ * no formato antigo, sem cabeçalho, continuam a ser aceites.
+ */
+Grafo* abrir_grafo_binario(const char* filename) {
+    FicheiroMapeado ficheiro;
+    if (!mapear_ficheiro(filename, &ficheiro, true)) return NULL;
+
+    CabecalhoBinario cab;
+    if (ficheiro.tamanho < sizeof(cab) ||
+        memcmp(ficheiro.dados, GRAFO_BINARIO_MAGIA, sizeof(cab.magia)) != 0) {
+        Grafo* grafo = carregar_grafo_binario_legado(&ficheiro);
+        desmapear_ficheiro(&ficheiro);
+        return grafo;
+    }
+    memcpy(&cab, ficheiro.dados, sizeof(cab));
+
+    uint64_t n = cab.num_vertices >= 0 ? (uint64_t)cab.num_vertices : 0;
+    bool valido = cab.versao == GRAFO_BINARIO_VERSAO &&
+                  cab.endianness == GRAFO_BINARIO_ENDIANNESS &&
+                  cab.num_vertices >= 0 && cab.capacidade_coordenadas >= 0 && cab.num_destinos >= 0 &&
+                  (cab.capacidade_coordenadas & (cab.capacidade_coordenadas - 1)) == 0 &&
+                  (uint64_t)cab.capacidade_coordenadas >= 2 * n &&
+                  (n == 0 || (cab.off_frequencias && cab.off_x && cab.off_y)) &&
+                  secao_valida(&ficheiro, cab.off_frequencias, n) &&
+                  secao_valida(&ficheiro, cab.off_x, n * sizeof(int32_t)) &&
+                  secao_valida(&ficheiro, cab.off_y, n * sizeof(int32_t)) &&
+                  secao_valida(&ficheiro, cab.off_coordenadas, (uint64_t)cab.capacidade_coordenadas * sizeof(int32_t)) &&
+                  secao_valida(&ficheiro, cab.off_inicio_membros, 257 * sizeof(int32_t)) &&
+                  secao_valida(&ficheiro, cab.off_membros, n * sizeof(int32_t)) &&
+                  secao_valida(&ficheiro, cab.off_inicio_arestas, (n + 1) * sizeof(int32_t)) &&
+                  secao_valida(&ficheiro, cab.off_destinos, (uint64_t)cab.num_destinos * sizeof(int32_t)) &&
+                  (cab.off_membros == 0 || cab.off_inicio_membros != 0) &&
+                  (cab.off_inicio_membros == 0 || n == 0 || cab.off_membros != 0) &&
+                  (cab.off_destinos == 0 || cab.off_inicio_arestas != 0) &&
+                  (cab.off_inicio_arestas == 0 || cab.num_destinos == 0 || cab.off_destinos != 0) &&
+                  (cab.off_inicio_arestas == 0 || cab.off_inicio_membros != 0);
+    if (!valido) {
+        desmapear_ficheiro(&ficheiro);
+        return NULL;
+    }
+
+    // As secções vazias (offset 0, ou tamanho 0 em ficheiros antigos) ficam a NULL.
+    char* frequencias = (char*)secao_binaria(&ficheiro, cab.off_frequencias, n);
+    int* xs = (int*)secao_binaria(&ficheiro, cab.off_x, n * sizeof(int32_t));
+    int* ys = (int*)secao_binaria(&ficheiro, cab.off_y, n * sizeof(int32_t));
+    int* coordenadas = (int*)secao_binaria(&ficheiro, cab.off_coordenadas,
+                                           (uint64_t)cab.capacidade_coordenadas * sizeof(int32_t));
+    int* inicio_membros = (int*)secao_binaria(&ficheiro, cab.off_inicio_membros, 257 * sizeof(int32_t));
+    int* membros = (int*)secao_binaria(&ficheiro, cab.off_membros, n * sizeof(int32_t));
+    int* inicio_arestas = (int*)secao_binaria(&ficheiro, cab.off_inicio_arestas, (n + 1) * sizeof(int32_t));
+    int* destinos = (int*)secao_binaria(&ficheiro, cab.off_destinos, (uint64_t)cab.num_destinos * sizeof(int32_t));
+
+    // Os ids das tabelas são usados diretamente como índices: um ficheiro
+    // truncado ou corrompido não pode apontar para fora do grafo.
+    valido = ids_validos(coordenadas, coordenadas ? cab.capacidade_coordenadas : 0, -1, (int32_t)n) &&
+             (!inicio_membros || buckets_validos(inicio_membros, membros, frequencias, (int32_t)n)) &&
+             (!inicio_arestas ||
+              csr_valida(inicio_arestas, destinos, cab.num_destinos, (int32_t)n, inicio_membros, frequencias));
+    Grafo* grafo = valido ? criar_grafo() : NULL;
+    if (grafo) {
+        grafo->indice = (Antena**)malloc((n > 0 ? n : 1) * sizeof(Antena*));
+        grafo->seguinte_celula = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+        valido = grafo->indice && grafo->seguinte_celula && (n == 0 || novo_bloco_antenas(grafo, (int)n));
+    }
+    if (!valido) {
+        if (grafo) destruir_grafo(grafo);
+        desmapear_ficheiro(&ficheiro);
+        return NULL;
+    }
+    grafo->capacidade_indice = (int)n;
+    grafo->mapeamento = ficheiro;
+
+    // Os vetores de atributos são as próprias secções do ficheiro.
+    grafo->frequencias = frequencias;
+    grafo->xs = xs;
+    grafo->ys = ys;
+    for (uint64_t i = 0; i < n; i++) {
+        if (!alocar_no_antena(grafo, frequencias[i], xs[i], ys[i])) {
+            destruir_grafo(grafo);
+            return NULL;
+        }
+    }
+    grafo->linhas = cab.linhas;
+    grafo->colunas = cab.colunas;
+
+    if (coordenadas) {
+        grafo->tabela_coordenadas = coordenadas;
+        grafo->capacidade_coordenadas = cab.capacidade_coordenadas;
+        if (!ligar_celulas(grafo)) {
+            destruir_grafo(grafo);
+            return NULL;
+        }
+    } else {
+        reservar_antenas(grafo, (int)n);
+        for (uint64_t i = 0; i < n; i++) indexar_coordenadas(grafo, grafo->indice[i]);
+    }
+
+    if (membros) {
+        for (int f = 0; f < 256; f++) {
+            grafo->membros_frequencia[f] = membros + inicio_membros[f];
+            grafo->tamanho_frequencia[f] = inicio_membros[f + 1] - inicio_membros[f];
+            if (grafo->tamanho_frequencia[f] > 0) {
+                grafo->num_arestas += (long long)grafo->tamanho_frequencia[f] * (grafo->tamanho_frequencia[f] - 1);
+            }
+        }
+        grafo->membros = membros;
+        grafo->num_vertices_ligados = (int)n;
+        rotular_componentes(grafo);
+        if (inicio_arestas) {
+            grafo->inicio_arestas = inicio_arestas;
+            grafo->destinos = destinos;
+            grafo->num_destinos = cab.num_destinos;
+            for (int f = 0; f < 256; f++) grafo->arestas_frequencia[f] = destinos;
+            grafo->arestas_materializadas = true;
+        }
+    } else {
+        grafo->arestas_materializadas = inicio_arestas != NULL;
+        conectar_antenas(grafo);
+    }
+    return grafo;
+}
+
+/**
+ * @brief Carrega o grafo de um ficheiro binário.
+ */
+Grafo* carregar_grafo_binario(const char* filename) {
+    ESTATISTICA_INICIO(t0);
+    Grafo* grafo = abrir_grafo_binario(filename);
+    if (grafo) ESTATISTICA_FIM(grafo, carregar_binario, t0);
+    return grafo;
+}
+
+/**
+ * @brief Constrói o nome de um ficheiro de um mapa particionado.
+ * @param prefixo Prefixo do mapa.
+ * @param faixa Número da faixa, ou -1 para o índice.
+ * @return Nome alocado com malloc (NULL sem memória).
+ */
+char* nome_ficheiro_faixa(const char* prefixo, int faixa) {
+    size_t tamanho = strlen(prefixo) + 32;
+    char* nome = (char*)malloc(tamanho);
+    if (!nome) return NULL;
+    if (faixa < 0) snprintf(nome, tamanho, "%s.idx", prefixo);
+    else snprintf(nome, tamanho, "%s.%d.bin", prefixo, faixa);
+    return nome;
+}
+
+/**
+ * @brief Guarda uma faixa de um mapa de texto como segmento binário.
+ *
+ * Conta as antenas do troço, lê-as diretamente para os vetores de atributos
+ * de um grafo só com elas (com os ids pela ordem do texto) e guarda-o.
+ * @return false sem memória ou se o segmento não pôde ser escrito.
+ */
+bool salvar_faixa(const char* dados, size_t tamanho, int y0, const char* nome, FaixaMapa* faixa, int* linhas,
+                  int* colunas) {
+    long long n = percorrer_mapa_texto(dados, tamanho, y0, NULL, NULL, NULL, linhas, colunas);
+    if (n > 0x7fffffff) return false;
+    Grafo* grafo = criar_grafo();
+    bool ok = reservar_antenas(grafo, (int)n);
+    if (ok) {
+        percorrer_mapa_texto(dados, tamanho, y0, grafo->frequencias, grafo->xs, grafo->ys, linhas, colunas);
+        for (long long i = 0; i < n; i++) {
+            indexar_coordenadas(grafo, alocar_no_antena(grafo, grafo->frequencias[i], grafo->xs[i], grafo->ys[i]));
+            faixa->contagem[(unsigned char)grafo->frequencias[i]]++;
+        }
+        grafo->linhas = y0 + *linhas;
+        grafo->colunas = *colunas;
+        conectar_antenas(grafo);
+        ok = salvar_grafo_binario(grafo, nome);
+    }
+    destruir_grafo(grafo);
+    return ok;
+}
+
+/**
+ * @brief Divide um mapa de texto em faixas de linhas guardadas em ficheiros separados.
+ */
+bool particionar_mapa(const char* filename, const char* prefixo, int altura_faixa) {
+    if (altura_faixa <= 0) return false;
+    FicheiroMapeado ficheiro;
+    if (!mapear_ficheiro(filename, &ficheiro, false)) return false;
+    const char* dados = ficheiro.dados;
+    size_t tamanho = ficheiro.tamanho;
+
+    CabecalhoFaixas cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magia, FAIXAS_MAGIA, sizeof(cab.magia));
+    cab.versao = FAIXAS_VERSAO;
+    cab.endianness = GRAFO_BINARIO_ENDIANNESS;
+    cab.altura_faixa = altura_faixa;
+
+    FaixaMapa* faixas = NULL;
+    int capacidade = 0;
+    bool ok = true;
+    for (size_t inicio = 0; ok && inicio < tamanho; cab.num_faixas++) {
+        // A faixa acaba a seguir ao altura_faixa-ésimo fim de linha.
+        size_t fim = inicio;
+        for (int l = 0; l < altura_faixa && fim < tamanho; l++) {
+            const char* fim_linha = (const char*)memchr(dados + fim, '\n', tamanho - fim);
+            fim = fim_linha ? (size_t)(fim_linha - dados) + 1 : tamanho;
+        }
+        if (cab.num_faixas == capacidade) {
+            capacidade = capacidade ? capacidade * 2 : 64;
+            FaixaMapa* novas = (FaixaMapa*)realloc(faixas, capacidade * sizeof(FaixaMapa));
+            if (!novas) {
+                ok = false;
+                break;
+            }
+            faixas = novas;
+        }
+        FaixaMapa* faixa = &faixas[cab.num_faixas];
+        memset(faixa, 0, sizeof(FaixaMapa));
+        int y0 = cab.num_faixas * altura_faixa, linhas = 0, colunas = 0;
+        char* nome = nome_ficheiro_faixa(prefixo, cab.num_faixas);
+        ok = nome && salvar_faixa(dados + inicio, fim - inicio, y0, nome, faixa, &linhas, &colunas);
+        free(nome);
+        for (int f = 0; f < 256; f++) cab.num_antenas += faixa->contagem[f];
+        cab.linhas = y0 + linhas;
+        if (colunas > cab.colunas) cab.colunas = colunas;
+        inicio = fim;
+    }
+    desmapear_ficheiro(&ficheiro);
+
+    char* nome = ok ? nome_ficheiro_faixa(prefixo, -1) : NULL;
+    FILE* file = nome ? fopen(nome, "wb") : NULL;
+    ok = file != NULL && fwrite(&cab, sizeof(cab), 1, file) == 1;
+    for (int i = 0; ok && i < cab.num_faixas; i++) {
+        int32_t contagem[256];
+        for (int f = 0; f < 256; f++) contagem[f] = faixas[i].contagem[f];
+        ok = fwrite(contagem, sizeof(contagem), 1, file) == 1;
+    }
+    if (file && fclose(file) != 0) ok = false;
+    free(nome);
+    free(faixas);
+    return ok;
+}
+
+/**
+ * @brief Abre um mapa particionado por particionar_mapa.
+ */
+MapaParticionado* abrir_mapa_particionado(const char* prefixo, size_t orcamento) {
+    char* nome = nome_ficheiro_faixa(prefixo, -1);
+    FILE* file = nome ? fopen(nome, "rb") : NULL;
+    free(nome);
+    if (!file) return NULL;
+
+    CabecalhoFaixas cab;
+    bool ok = fread(&cab, sizeof(cab), 1, file) == 1 && memcmp(cab.magia, FAIXAS_MAGIA, sizeof(cab.magia)) == 0 &&
+              cab.versao == FAIXAS_VERSAO && cab.endianness == GRAFO_BINARIO_ENDIANNESS &&
+              cab.altura_faixa > 0 && cab.num_faixas >= 0;
+    MapaParticionado* mapa = ok ? (MapaParticionado*)calloc(1, sizeof(MapaParticionado)) : NULL;
+    if (mapa) {
+        mapa->prefixo = (char*)malloc(strlen(prefixo) + 1);
+        mapa->faixas = (FaixaMapa*)calloc(cab.num_faixas > 0 ? cab.num_faixas : 1, sizeof(FaixaMapa));
+        ok = mapa->prefixo && mapa->faixas;
+    }
+    for (int i = 0; ok && i < cab.num_faixas; i++) {
+        int32_t contagem[256];
+        ok = fread(contagem, sizeof(contagem), 1, file) == 1;
+        for (int f = 0; ok && f < 256; f++) {
+            ok = contagem[f] >= 0;
+            mapa->faixas[i].contagem[f] = contagem[f];
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        fechar_mapa_particionado(mapa);
+        return NULL;
+    }
+
+    strcpy(mapa->prefixo, prefixo);
+    mapa->linhas = cab.linhas;
+    mapa->colunas = cab.colunas;
+    mapa->altura_faixa = cab.altura_faixa;
+    mapa->num_faixas = cab.num_faixas;
+    mapa->num_antenas = cab.num_antenas;
+    mapa->orcamento = orcamento;
+    return mapa;
+}
+
+/**
+ * @brief Liberta o segmento carregado de uma faixa.
+ */
+void descarregar_faixa(MapaParticionado* mapa, int faixa) {
+    FaixaMapa* f = &mapa->faixas[faixa];
+    if (!f->grafo) return;
+    destruir_grafo(f->grafo);
+    f->grafo = NULL;
+    mapa->memoria_usada -= f->memoria;
+    f->memoria = 0;
+}
+
+/**
+ * @brief Fecha um mapa particionado, libertando todos os segmentos carregados.
+ */
+void fechar_mapa_particionado(MapaParticionado* mapa) {
+    if (!mapa) return;
+    for (int i = 0; mapa->faixas && i < mapa->num_faixas; i++) descarregar_faixa(mapa, i);
+    free(mapa->faixas);
+    free(mapa->prefixo);
+    free(mapa);
+}
+
+/**
+ * @brief Obtém o segmento de uma faixa, carregando-o se for preciso.
+ *
+ * Antes de registar um segmento acabado de ler, são libertados os segmentos
+ * com o acesso mais antigo até o novo caber no orçamento.
+ */
+Grafo* faixa_mapa(MapaParticionado* mapa, int faixa) {
+    if (faixa < 0 || faixa >= mapa->num_faixas) return NULL;
+    FaixaMapa* f = &mapa->faixas[faixa];
+    f->uso = ++mapa->relogio;
+    if (f->grafo) return f->grafo;
+
+    char* nome = nome_ficheiro_faixa(mapa->prefixo, faixa);
+    Grafo* grafo = nome ? carregar_grafo_binario(nome) : NULL;
+    free(nome);
+    if (!grafo) return NULL;
+    MemoriaGrafo memoria;
+    memoria_grafo(grafo, &memoria);
+
+    while (mapa->memoria_usada > 0 && mapa->memoria_usada + memoria.total > mapa->orcamento) {
+        int antiga = -1;
+        for (int i = 0; i < mapa->num_faixas; i++) {
+            if (mapa->faixas[i].grafo && (antiga < 0 || mapa->faixas[i].uso < mapa->faixas[antiga].uso)) antiga = i;
+        }
+        descarregar_faixa(mapa, antiga);
+    }
+    f->grafo = grafo;
+    f->memoria = memoria.total;
+    mapa->memoria_usada += memoria.total;
+    mapa->carregamentos++;
+    return grafo;
+}
+
+/**
+ * @brief Procura a antena numa posição de um mapa particionado.
+ */
+Antena* encontrar_antena_particionada(MapaParticionado* mapa, int x, int y) {
+    if (y < 0) return NULL;
+    Grafo* grafo = faixa_mapa(mapa, y / mapa->altura_faixa);
+    return grafo ? encontrar_antena(grafo, x, y) : NULL;
+}
+
+/**
+ * @brief Executa uma BFS num mapa particionado, atravessando as faixas.
+ *
+ * A componente da antena inicial é a clique da sua frequência: depois da
+ * inicial, as restantes são visitadas faixa a faixa pela ordem dos buckets,
+ * que é a ordem dos ids do mapa completo.
+ */
+long long bfs_particionada(MapaParticionado* mapa, int x, int y, void (*callback)(Antena*)) {
+    Antena* inicio = encontrar_antena_particionada(mapa, x, y);
+    if (!inicio) return 0;
+    int faixa_inicio = y / mapa->altura_faixa, id_inicio = inicio->id;
+    unsigned char f = (unsigned char)inicio->frequencia;
+    callback(inicio);
+    long long visitadas = 1;
+
+    for (int i = 0; i < mapa->num_faixas; i++) {
+        if (mapa->faixas[i].contagem[f] == 0) continue;
+        Grafo* grafo = faixa_mapa(mapa, i);
+        if (!grafo) return -1;
+        const int* bucket = grafo->membros_frequencia[f];
+        for (int k = 0; k < grafo->tamanho_frequencia[f]; k++) {
+            if (i == faixa_inicio && bucket[k] == id_inicio) continue;
+            callback(grafo->indice[bucket[k]]);
+            visitadas++;
+        }
+    }
+    return visitadas;
+}
+
+/**
+ * @brief Lista interseções entre duas frequências de um mapa particionado.
+ *
+ * Os buckets das duas frequências de cada faixa são intercalados por id, o
+ * que mantém no grafo temporário a ordem relativa das antenas do mapa
+ * completo.
+ */
+bool listar_intersecoes_particionadas(MapaParticionado* mapa, char freqA, char freqB,
+                                      void (*callback)(Antena*, Antena*)) {
+    unsigned char a = (unsigned char)freqA, b = (unsigned char)freqB;
+    long long total = 0;
+    for (int i = 0; i < mapa->num_faixas; i++) {
+        total += mapa->faixas[i].contagem[a] + (a != b ? mapa->faixas[i].contagem[b] : 0);
+    }
+    if (total > 0x7fffffff) return false;
+
+    Grafo* temporario = criar_grafo();
+    bool ok = reservar_antenas(temporario, (int)total);
+    for (int i = 0; ok && i < mapa->num_faixas; i++) {
+        if (mapa->faixas[i].contagem[a] == 0 && mapa->faixas[i].contagem[b] == 0) continue;
+        Grafo* grafo = faixa_mapa(mapa, i);
+        if (!grafo) {
+            ok = false;
+            break;
+        }
+        const int* membros_a = grafo->membros_frequencia[a];
+        const int* membros_b = grafo->membros_frequencia[b];
+        int pa = 0, fa = grafo->tamanho_frequencia[a];
+        int pb = 0, fb = a != b ? grafo->tamanho_frequencia[b] : 0;
+        while (pa < fa || pb < fb) {
+            int id = pb >= fb || (pa < fa && membros_a[pa] < membros_b[pb]) ? membros_a[pa++] : membros_b[pb++];
+            Antena* antena = grafo->indice[id];
+            indexar_coordenadas(temporario, criar_no_antena(temporario, antena->frequencia, antena->x, antena->y));
+        }
+    }
+    if (ok) {
+        temporario->linhas = mapa->linhas;
+        temporario->colunas = mapa->colunas;
+        listar_intersecoes(temporario, freqA, freqB, callback);
+    }
+    destruir_grafo(temporario);
+    return ok;
+}
+
+/**
+ * @brief Imprime a matriz no formato binário (em bits).
+ */
+void imprimir_matriz_em_binario(Grafo* grafo, int linhas, int colunas) {
+    renderizar_matriz(grafo, linhas, colunas, true);
+}
+
+/**
+ * @brief Calcula a memória ocupada por cada estrutura do grafo.
+ */
+void memoria_grafo(Grafo* grafo, MemoriaGrafo* memoria) {
+    memset(memoria, 0, sizeof(*memoria));
+    memoria->grafo = sizeof(Grafo);
+    for (BlocoAntenas* bloco = grafo->blocos_antenas; bloco; bloco = bloco->prox) {
+        memoria->antenas += sizeof(BlocoAntenas) + (size_t)bloco->capacidade * sizeof(Antena);
+    }
+    memoria->indice = (size_t)grafo->capacidade_indice * sizeof(Antena*);
+    if (grafo->xs && !vetor_mapeado(grafo, grafo->xs)) {
+        memoria->indice += (size_t)grafo->capacidade_indice * (sizeof(char) + 2 * sizeof(int));
+    }
+    if (grafo->seguinte_celula) memoria->coordenadas += (size_t)grafo->capacidade_indice * sizeof(int);
+    if (grafo->tabela_coordenadas && !vetor_mapeado(grafo, grafo->tabela_coordenadas)) {
+        memoria->coordenadas += (size_t)grafo->capacidade_coordenadas * sizeof(int);
+    }
+    if (grafo->membros && !vetor_mapeado(grafo, grafo->membros)) {
+        memoria->buckets = (size_t)grafo->capacidade_membros * sizeof(int);
+    }
+    if (grafo->inicio_arestas && !vetor_mapeado(grafo, grafo->inicio_arestas)) {
+        memoria->arestas += (size_t)grafo->capacidade_indice * sizeof(int);
+    }
+    if (grafo->destinos && !vetor_mapeado(grafo, grafo->destinos)) {
+        memoria->arestas += (size_t)grafo->num_destinos * sizeof(int);
+    }
+    for (int f = 0; f < 256; f++) {
+        memoria->buckets += (size_t)grafo->capacidade_frequencia[f] * sizeof(int);
+        memoria->arestas += (size_t)grafo->largura_arestas[f] * grafo->linhas_arestas[f] * sizeof(int);
+    }
+    if (grafo->grelha.frequencias) {
+        size_t linhas = (size_t)grafo->grelha.linhas;
+        memoria->grelha = linhas * grafo->grelha.colunas + linhas * grafo->grelha.palavras_linha * sizeof(uint64_t);
+    }
+    memoria->mapeamento = grafo->mapeamento.tamanho;
+    memoria->total = memoria->grafo + memoria->antenas + memoria->indice + memoria->coordenadas + memoria->buckets +
+                     memoria->arestas + memoria->grelha + memoria->mapeamento;
+}
+
+#ifdef GRAFO_ESTATISTICAS
+/**
+ * @brief Escreve os tempos de uma operação como membro de um objeto JSON.
+ */
+void imprimir_operacao(FILE* destino, const char* separador, const char* nome, const OperacaoEstatistica* operacao) {
+    fprintf(destino, "%s\"%s\":{\"chamadas\":%lld,\"total_us\":%.1f,\"max_us\":%.1f}", separador, nome, operacao->chamadas,
+            operacao->tempo_total_ns / 1e3, operacao->tempo_max_ns / 1e3);
+}
+#endif
+
+/**
+ * @brief Escreve um instantâneo das estatísticas do grafo numa linha JSON.
+ */
+void imprimir_estatisticas(Grafo* grafo, FILE* destino) {
+    MemoriaGrafo m;
+    memoria_grafo(grafo, &m);
+    fprintf(destino, "{\"antenas\":%d,\"arestas\":%lld,\"componentes\":%d", grafo->num_vertices, grafo->num_arestas,
+            grafo->num_componentes);
+    fprintf(destino, ",\"memoria\":{\"grafo\":%zu,\"antenas\":%zu,\"indice\":%zu,\"coordenadas\":%zu,"
+            "\"buckets\":%zu,\"arestas\":%zu,\"grelha\":%zu,\"mapeamento\":%zu,\"total\":%zu}",
+            m.grafo, m.antenas, m.indice, m.coordenadas, m.buckets, m.arestas, m.grelha, m.mapeamento, m.total);
+#ifdef GRAFO_ESTATISTICAS
+    const EstatisticasGrafo* e = &grafo->estatisticas;
+    fputs(",\"operacoes\":{", destino);
+    imprimir_operacao(destino, "", "carregar_texto", &e->carregar_texto);
+    imprimir_operacao(destino, ",", "carregar_binario", &e->carregar_binario);
+    imprimir_operacao(destino, ",", "salvar_binario", &e->salvar_binario);
+    imprimir_operacao(destino, ",", "conectar", &e->conectar);
+    imprimir_operacao(destino, ",", "dfs", &e->dfs);
+    imprimir_operacao(destino, ",", "bfs", &e->bfs);
+    imprimir_operacao(destino, ",", "caminhos", &e->caminhos);
+    imprimir_operacao(destino, ",", "caminho_mais_curto", &e->caminho_mais_curto);
+    imprimir_operacao(destino, ",", "k_caminhos", &e->k_caminhos);
+    imprimir_operacao(destino, ",", "caminho_ponderado", &e->caminho_ponderado);
+    imprimir_operacao(destino, ",", "intersecoes", &e->intersecoes);
+    fprintf(destino, "},\"contadores\":{\"arestas_criadas\":%lld,\"sondagens_coordenadas\":%lld,"
+            "\"vertices_visitados\":%lld,\"caminhos_emitidos\":%lld,\"intersecoes_emitidas\":%lld}",
+            e->arestas_criadas, e->sondagens_coordenadas, e->vertices_visitados, e->caminhos_emitidos,
+            e->intersecoes_emitidas);
+#endif
+    fputs("}\n", destino);
+}
+
+/**
+ * @brief Põe a zero os tempos e contadores do grafo.
+ */
+void reiniciar_estatisticas(Grafo* grafo) {
+#ifdef GRAFO_ESTATISTICAS
+    memset(&grafo->estatisticas, 0, sizeof(grafo->estatisticas));
+#else
+    (void)grafo;
+#endif
 }
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <math.h>
 
 /**
@@ -18,29 +19,255 @@
 typedef struct Antena {
     char frequencia;         /**< Frequência da antena. */
     int x, y;                /**< Coordenadas da antena. */
-    bool visitado;           /**< Indica se a antena foi visitada (para buscas). */
-    struct Aresta* arestas;  /**< Lista de conexões (arestas). */
+    int id;                  /**< Índice da antena no grafo (ordem de inserção; ver remover_antena). */
     struct Antena* prox;     /**< Próxima antena na lista. */
 } Antena;
 
 /**
- * @struct Aresta
- * @brief Representa uma conexão entre duas antenas.
+ * @struct FicheiroMapeado
+ * @brief Conteúdo de um ficheiro mapeado em memória (ou lido, sem mmap).
  */
-typedef struct Aresta {
-    Antena* destino;         /**< Antena de destino da conexão. */
-    struct Aresta* prox;     /**< Próxima aresta na lista. */
-} Aresta;
+typedef struct {
+    char* dados;             /**< Bytes do ficheiro (NULL se vazio). */
+    size_t tamanho;          /**< Tamanho em bytes. */
+    bool mapeado;            /**< true se veio de mmap, false se foi lido com fread. */
+} FicheiroMapeado;
+
+/**
+ * @struct GrelhaDensa
+ * @brief Vista densa e contígua da grelha do mapa.
+ *
+ * A célula (x, y) corresponde ao bit @c x%64 de @c ocupacao[y*palavras_linha + x/64]
+ * e ao byte @c frequencias[y*colunas + x]. As células livres têm o bit a 0 e
+ * frequência 0. Se várias antenas partilham uma célula fica a mais antiga.
+ */
+typedef struct {
+    int linhas, colunas;         /**< Dimensões alocadas (colunas múltiplo de 64). */
+    int palavras_linha;          /**< Palavras de 64 bits por linha do bitmap. */
+    uint64_t* ocupacao;          /**< Bitmap de células ocupadas. */
+    unsigned char* frequencias;  /**< Plano de frequências, um byte por célula (NULL se inativa). */
+} GrelhaDensa;
+
+/**
+ * @struct MemoriaGrafo
+ * @brief Bytes ocupados por cada estrutura de um grafo (ver memoria_grafo).
+ *
+ * Vetores que apontam para o ficheiro binário mapeado não contam nas suas
+ * estruturas; o ficheiro inteiro conta em @c mapeamento.
+ */
+typedef struct {
+    size_t grafo;            /**< A própria estrutura Grafo. */
+    size_t antenas;          /**< Blocos da arena de antenas. */
+    size_t indice;           /**< Índice por id e vetores de atributos das antenas. */
+    size_t coordenadas;      /**< Tabela de hash de coordenadas. */
+    size_t buckets;          /**< Buckets de frequência (@c membros). */
+    size_t arestas;          /**< CSR das arestas materializadas. */
+    size_t grelha;           /**< Bitmap e plano de frequências da grelha densa. */
+    size_t mapeamento;       /**< Ficheiro binário mapeado ou lido. */
+    size_t total;            /**< Soma de todos os campos anteriores. */
+} MemoriaGrafo;
+
+#ifdef GRAFO_ESTATISTICAS
+/**
+ * @struct OperacaoEstatistica
+ * @brief Chamadas e tempo acumulado de uma operação.
+ */
+typedef struct {
+    long long chamadas;      /**< Número de chamadas. */
+    long long tempo_total_ns;/**< Tempo total, em nanossegundos. */
+    long long tempo_max_ns;  /**< Chamada mais lenta, em nanossegundos. */
+} OperacaoEstatistica;
+
+/**
+ * @struct EstatisticasGrafo
+ * @brief Contadores de desempenho de um grafo.
+ *
+ * Só existe quando compilado com -DGRAFO_ESTATISTICAS; sem essa macro a
+ * instrumentação desaparece por completo de grafo.c. Os contadores são
+ * atualizados atomicamente, pelo que podem ser usados com consultas em
+ * paralelo.
+ */
+typedef struct {
+    OperacaoEstatistica carregar_texto;     /**< carregar_grafo_arquivo. */
+    OperacaoEstatistica carregar_binario;   /**< carregar_grafo_binario. */
+    OperacaoEstatistica salvar_binario;     /**< salvar_grafo_binario. */
+    OperacaoEstatistica conectar;           /**< conectar_antenas. */
+    OperacaoEstatistica dfs;                /**< dfs. */
+    OperacaoEstatistica bfs;                /**< bfs, bfs_paralela e bfs_multiplas_fontes. */
+    OperacaoEstatistica caminhos;           /**< encontrar_caminhos*. */
+    OperacaoEstatistica caminho_mais_curto; /**< caminho_mais_curto. */
+    OperacaoEstatistica k_caminhos;         /**< k_caminhos_mais_curtos. */
+    OperacaoEstatistica caminho_ponderado;  /**< caminho_dijkstra e caminho_a_estrela. */
+    OperacaoEstatistica intersecoes;        /**< listar_intersecoes. */
+    long long arestas_criadas;       /**< Arestas (dirigidas) criadas por conectar_antenas. */
+    long long sondagens_coordenadas; /**< Posições examinadas na tabela de coordenadas. */
+    long long vertices_visitados;    /**< Antenas visitadas por DFS e BFS. */
+    long long caminhos_emitidos;     /**< Caminhos encontrados. */
+    long long intersecoes_emitidas;  /**< Pares reportados por listar_intersecoes. */
+} EstatisticasGrafo;
+#endif
 
 /**
  * @struct Grafo
  * @brief Representa um grafo contendo antenas e conexões.
+ *
+ * As antenas são agrupadas por frequência em buckets: os membros da
+ * frequência @c f são os ids em @c membros_frequencia[f][0 .. tamanho_frequencia[f]),
+ * por ordem de id. Como todas as antenas da mesma frequência estão ligadas
+ * entre si, cada bucket é uma clique implícita e não é preciso guardar arestas.
+ * conectar_antenas põe os buckets lado a lado em @c membros; um bucket que
+ * cresce depois disso passa para um bloco próprio, com folga, para que
+ * inserir_antena e remover_antena só mexam no bucket da frequência alterada.
+ *
+ * Opcionalmente (ver definir_arestas_materializadas) as arestas são também
+ * materializadas em formato CSR: os vizinhos da antena com id @c i e
+ * frequência @c f são os @c tamanho_frequencia[f] - 1 ids em
+ * @c arestas_frequencia[f] + inicio_arestas[i]. As linhas geradas por
+ * conectar_antenas ficam todas em @c destinos; as de uma frequência que
+ * cresce passam para um bloco próprio, com @c largura_arestas[f] posições por
+ * linha, onde a linha do membro na posição @c r do bucket começa em
+ * @c r * largura_arestas[f].
+ *
+ * Antenas com as mesmas coordenadas formam uma cadeia em @c seguinte_celula,
+ * por ordem decrescente de id; a tabela de coordenadas guarda a primeira
+ * (a mais recente) e a grelha densa a última (a mais antiga).
+ *
+ * Os atributos das antenas são também guardados em estrutura de vetores,
+ * indexados pelo id (@c frequencias, @c xs, @c ys), para que as passagens
+ * por todas as antenas leiam memória contígua em vez de seguir ponteiros.
+ *
+ * As buscas não escrevem no grafo: o estado de visita de cada consulta vive
+ * num contexto próprio da thread que a faz. Várias threads podem por isso
+ * consultar o mesmo grafo em simultâneo, desde que nenhuma o altere, e um
+ * callback pode iniciar outra consulta sem perturbar a que está em curso.
  */
 typedef struct {
     Antena* vertices;        /**< Lista de antenas (vértices). */
     int num_vertices;        /**< Número de antenas no grafo. */
+    struct BlocoAntenas* blocos_antenas; /**< Arena onde vivem as antenas. */
+    int linhas, colunas;     /**< Dimensões da grelha do mapa. */
+    Antena** indice;         /**< Antenas indexadas pelo id. */
+    int capacidade_indice;   /**< Capacidade alocada de @c indice e dos vetores de atributos. */
+    char* frequencias;       /**< Frequência de cada antena, por id. */
+    int* xs;                 /**< Coordenada X de cada antena, por id. */
+    int* ys;                 /**< Coordenada Y de cada antena, por id. */
+    int* tabela_coordenadas; /**< Hash aberta (x,y) -> id; -1 marca posição livre. */
+    int capacidade_coordenadas; /**< Tamanho da tabela (potência de 2). */
+    int num_coordenadas;     /**< Posições ocupadas da tabela (< num_vertices se há antenas sobrepostas). */
+    int* seguinte_celula;    /**< Próxima antena (de id menor) com as mesmas coordenadas, ou -1; por id. */
+    Antena* antenas_livres;  /**< Nós libertados por remover_antena, reutilizados pela arena. */
+    int* membros;            /**< Buckets gerados por conectar_antenas, lado a lado (por ordem de id). */
+    int capacidade_membros;  /**< Capacidade alocada de @c membros (0 se vem do ficheiro mapeado). */
+    int* membros_frequencia[256]; /**< Bucket de cada frequência (em @c membros ou num bloco próprio). */
+    int tamanho_frequencia[256];  /**< Número de antenas de cada frequência. */
+    int capacidade_frequencia[256]; /**< Capacidade do bloco próprio do bucket (0 se está em @c membros). */
+    int num_vertices_ligados;/**< Antenas cobertas pelo último conectar_antenas. */
+    int num_componentes;     /**< Número de componentes conexas. */
+    int componente_frequencia[256]; /**< Componente de cada frequência (-1 se vazia). */
+    unsigned char frequencia_componente[256]; /**< Frequência de cada componente. */
+    bool arestas_materializadas; /**< Se true, conectar_antenas gera também a CSR. */
+    int* inicio_arestas;     /**< Início da linha CSR de cada antena, por id, ou NULL em modo de cliques implícitas. */
+    int* destinos;           /**< Linhas CSR geradas por conectar_antenas (ou vindas do ficheiro). */
+    long long num_destinos;  /**< Entradas de @c destinos. */
+    int* arestas_frequencia[256]; /**< Linhas CSR de cada frequência: @c destinos ou um bloco próprio. */
+    int largura_arestas[256];     /**< Posições por linha do bloco próprio (0 se as linhas estão em @c destinos). */
+    int linhas_arestas[256];      /**< Linhas com espaço no bloco próprio. */
+    long long num_arestas;   /**< Número de arestas (dirigidas), implícitas ou não. */
+    FicheiroMapeado mapeamento; /**< Ficheiro binário cujos vetores o grafo usa diretamente. */
+    GrelhaDensa grelha;      /**< Grelha densa opcional (ver definir_grelha_densa). */
+#ifdef GRAFO_ESTATISTICAS
+    EstatisticasGrafo estatisticas; /**< Contadores de desempenho. */
+#endif
 } Grafo;
 
+#define GRAFO_BINARIO_MAGIA "EDA2GRF"      /**< Assinatura do formato binário (8 bytes com o '\0'). */
+#define GRAFO_BINARIO_VERSAO 1u            /**< Versão atual do formato binário. */
+#define GRAFO_BINARIO_ENDIANNESS 0x01020304u /**< Marcador para detetar a ordem dos bytes. */
+#define GRAFO_BINARIO_ALINHAMENTO 64       /**< Alinhamento (em bytes) das secções. */
+
+/**
+ * @struct CabecalhoBinario
+ * @brief Cabeçalho do formato binário guardado por salvar_grafo_binario.
+ *
+ * Todos os offsets são relativos ao início do ficheiro e múltiplos de
+ * GRAFO_BINARIO_ALINHAMENTO; um offset 0 indica uma secção ausente ou vazia. Os
+ * vetores estão pela ordem dos ids e podem ser usados diretamente a partir
+ * de um mmap do ficheiro, sem qualquer conversão.
+ */
+typedef struct {
+    char magia[8];                /**< GRAFO_BINARIO_MAGIA. */
+    uint32_t versao;              /**< GRAFO_BINARIO_VERSAO. */
+    uint32_t endianness;          /**< GRAFO_BINARIO_ENDIANNESS na ordem de quem escreveu. */
+    int32_t linhas, colunas;      /**< Dimensões da grelha. */
+    int32_t num_vertices;         /**< Número de antenas. */
+    int32_t capacidade_coordenadas; /**< Tamanho da tabela de coordenadas. */
+    int64_t num_arestas;          /**< Número de arestas (dirigidas). */
+    uint64_t off_frequencias;     /**< char[num_vertices]. */
+    uint64_t off_x;               /**< int32[num_vertices]. */
+    uint64_t off_y;               /**< int32[num_vertices]. */
+    uint64_t off_coordenadas;     /**< int32[capacidade_coordenadas] (hash (x,y) -> id). */
+    uint64_t off_inicio_membros;  /**< int32[257] (offsets dos buckets de frequência). */
+    uint64_t off_membros;         /**< int32[num_vertices] (ids agrupados por frequência). */
+    uint64_t off_inicio_arestas;  /**< int32[num_vertices + 1] (offsets CSR). */
+    uint64_t off_destinos;        /**< int32[num_destinos] (destinos CSR). */
+    int64_t num_destinos;         /**< Entradas em off_destinos. */
+} CabecalhoBinario;
+
+#define FAIXAS_MAGIA "EDA2FXS"             /**< Assinatura do índice de um mapa particionado. */
+#define FAIXAS_VERSAO 1u                   /**< Versão atual do índice de faixas. */
+
+/**
+ * @struct CabecalhoFaixas
+ * @brief Cabeçalho do índice de um mapa particionado (ficheiro prefixo.idx).
+ *
+ * É seguido de num_faixas blocos int32[256] com o número de antenas de cada
+ * frequência em cada faixa. A faixa @c i cobre as linhas
+ * [i * altura_faixa, (i + 1) * altura_faixa) e está guardada no formato
+ * binário normal em prefixo.i.bin.
+ */
+typedef struct {
+    char magia[8];                /**< FAIXAS_MAGIA. */
+    uint32_t versao;              /**< FAIXAS_VERSAO. */
+    uint32_t endianness;          /**< GRAFO_BINARIO_ENDIANNESS na ordem de quem escreveu. */
+    int32_t linhas, colunas;      /**< Dimensões da grelha completa. */
+    int32_t altura_faixa;         /**< Linhas por faixa. */
+    int32_t num_faixas;           /**< Número de faixas. */
+    int64_t num_antenas;          /**< Total de antenas do mapa. */
+} CabecalhoFaixas;
+
+/**
+ * @struct FaixaMapa
+ * @brief Uma faixa de linhas de um mapa particionado.
+ */
+typedef struct {
+    Grafo* grafo;                 /**< Segmento carregado, ou NULL se não está em memória. */
+    size_t memoria;               /**< Memória do segmento carregado (memoria_grafo). */
+    unsigned long long uso;       /**< Último acesso, para escolher a faixa a descarregar. */
+    int contagem[256];            /**< Antenas de cada frequência na faixa. */
+} FaixaMapa;
+
+/**
+ * @struct MapaParticionado
+ * @brief Mapa dividido em faixas de linhas guardadas em ficheiros separados.
+ *
+ * Os segmentos são carregados quando uma consulta precisa deles e mantidos
+ * em memória enquanto cabem no orçamento; quando não cabem, são libertados
+ * os usados há mais tempo (LRU). As antenas devolvidas pertencem ao
+ * segmento da sua faixa e os seus ids são locais a esse segmento.
+ */
+typedef struct {
+    char* prefixo;                /**< Prefixo dos ficheiros (prefixo.idx e prefixo.<faixa>.bin). */
+    int linhas, colunas;          /**< Dimensões da grelha completa. */
+    int altura_faixa;             /**< Linhas por faixa. */
+    int num_faixas;               /**< Número de faixas. */
+    long long num_antenas;        /**< Total de antenas do mapa. */
+    FaixaMapa* faixas;            /**< Faixas, por ordem de linha. */
+    size_t orcamento;             /**< Memória máxima dos segmentos carregados. */
+    size_t memoria_usada;         /**< Memória dos segmentos carregados. */
+    unsigned long long relogio;   /**< Contador de acessos às faixas. */
+    long long carregamentos;      /**< Segmentos lidos do disco desde a abertura. */
+} MapaParticionado;
+
 // ======== FUNÇÕES BÁSICAS ========
 
 /**
@@ -65,18 +292,104 @@ void destruir_grafo(Grafo* grafo);
  */
 Antena* adicionar_antena(Grafo* grafo, char frequencia, int x, int y);
 
+/**
+ * @brief Adiciona uma antena e liga-a de imediato às da sua frequência.
+ *
+ * Ao contrário de adicionar_antena seguida de conectar_antenas, só o bucket
+ * da frequência da antena é atualizado (e as componentes, se a frequência
+ * era nova), em tempo amortizado proporcional ao tamanho da frequência; com
+ * as arestas materializadas acrescenta-se a nova antena às linhas CSR dessa
+ * frequência, no mesmo tempo amortizado.
+ *
+ * Se o grafo ainda não estava todo ligado (nunca foi chamado
+ * conectar_antenas, ou houve adicionar_antena desde então), a antena é
+ * adicionada e é feito um conectar_antenas completo, em tempo linear no
+ * número de antenas; as inserções seguintes já são incrementais.
+ *
+ * Toda a memória necessária é reservada antes de alterar o grafo: se falhar,
+ * a função devolve NULL e o grafo fica como estava.
+ * @param grafo Ponteiro para o grafo.
+ * @param frequencia Letra identificadora da frequência.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Ponteiro para a antena criada, ou NULL sem memória.
+ */
+Antena* inserir_antena(Grafo* grafo, char frequencia, int x, int y);
+
+/**
+ * @brief Remove uma antena do grafo.
+ *
+ * Atualiza o bucket da frequência da antena, as componentes, a tabela de
+ * coordenadas e a grelha densa, sem reconstruir as restantes ligações. Para
+ * manter os ids contíguos, a antena com o maior id passa a usar o id da
+ * removida, o que altera também o bucket da frequência dessa antena. O
+ * custo é proporcional ao tamanho das duas frequências (ao quadrado, com as
+ * arestas materializadas, cujas linhas são reescritas no sítio) e ao número
+ * de antenas nas células das duas antenas. O nó removido é reutilizado por
+ * inserções seguintes, pelo que o ponteiro deixa de ser válido.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Antena a remover.
+ * @return false se a antena não pertence ao grafo.
+ */
+bool remover_antena(Grafo* grafo, Antena* antena);
+
+/**
+ * @brief Reserva espaço para um dado número total de antenas.
+ *
+ * Evita realocações sucessivas do índice e da tabela de coordenadas quando
+ * o número de antenas é conhecido de antemão (por exemplo, nos loaders), e
+ * garante um bloco contíguo na arena para as antenas em falta.
+ * @param grafo Ponteiro para o grafo.
+ * @param total Número total de antenas esperado.
+ * @return false se não houve memória.
+ */
+bool reservar_antenas(Grafo* grafo, int total);
+
 /**
  * @brief Conecta automaticamente antenas com mesma frequência.
+ *
+ * Reconstrói os buckets de frequência em tempo linear (e a CSR, se as
+ * arestas estiverem materializadas); deve ser chamada depois de todas as
+ * antenas terem sido adicionadas.
  * @param grafo Ponteiro para o grafo.
  */
 void conectar_antenas(Grafo* grafo);
 
+/**
+ * @brief Ativa ou desativa a materialização explícita das arestas.
+ *
+ * Por omissão as frequências são cliques implícitas (memória O(V)). Com as
+ * arestas materializadas é construída uma CSR com k*(k-1) entradas por
+ * frequência com k antenas. Se o grafo já estiver ligado, a CSR é criada ou
+ * libertada imediatamente.
+ * @param grafo Ponteiro para o grafo.
+ * @param materializar true para materializar as arestas.
+ * @return false se não houve memória para construir a CSR.
+ */
+bool definir_arestas_materializadas(Grafo* grafo, bool materializar);
+
+/**
+ * @brief Ativa ou desativa a grelha densa (bitmap de ocupação e plano de frequências).
+ *
+ * Com a grelha ativa, adicionar_antena mantém-na atualizada (crescendo-a
+ * quando necessário) e é usada por encontrar_antena, frequencia_celula,
+ * colunas_com_frequencia e pela impressão da matriz. Ocupa um byte e um bit
+ * por célula; só compensa em mapas densos, pelo que está desativada por
+ * omissão. Coordenadas negativas ficam fora da grelha. Se adicionar_antena
+ * não a conseguir crescer (sem memória, ou acima de 2^30 células), a grelha
+ * é desativada e as pesquisas voltam à tabela de coordenadas.
+ * @param grafo Ponteiro para o grafo.
+ * @param ativar true para construir a grelha, false para a libertar.
+ * @return false se não houve memória.
+ */
+bool definir_grelha_densa(Grafo* grafo, bool ativar);
+
 // ======== BUSCAS ========
 
 /**
  * @brief Executa busca em profundidade (DFS) a partir de uma antena.
  * @param grafo Ponteiro para o grafo.
- * @param inicio Antena de início.
+ * @param inicio Antena de início (se NULL não é visitada nenhuma antena).
  * @param callback Função a ser chamada para cada antena visitada.
  */
 void dfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*));
@@ -84,11 +397,48 @@ void dfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*));
 /**
  * @brief Executa busca em largura (BFS) a partir de uma antena.
  * @param grafo Ponteiro para o grafo.
- * @param inicio Antena de início.
+ * @param inicio Antena de início (se NULL não é visitada nenhuma antena).
  * @param callback Função a ser chamada para cada antena visitada.
  */
 void bfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*));
 
+/**
+ * @brief Executa uma BFS paralela, sincronizada por níveis.
+ *
+ * Cada fronteira é expandida por várias threads (OpenMP), com reivindicação
+ * atómica das antenas visitadas e buffers locais por thread. Com as arestas
+ * materializadas, fronteiras grandes são expandidas de baixo para cima.
+ * As antenas são entregues ao callback por nível e, dentro de cada nível,
+ * por id crescente, independentemente do número de threads. Sem OpenMP a
+ * execução é sequencial.
+ * @param grafo Ponteiro para o grafo.
+ * @param inicio Antena de início (se NULL não é visitada nenhuma antena e
+ *               todos os níveis ficam a -1).
+ * @param niveis Recebe o nível de cada antena (indexado por id, -1 se
+ *               inalcançável), ou NULL.
+ * @param callback Função chamada para cada antena visitada, ou NULL.
+ * @return false se faltou memória.
+ */
+bool bfs_paralela(Grafo* grafo, Antena* inicio, int* niveis, void (*callback)(Antena*));
+
+/**
+ * @brief Executa BFS a partir de várias antenas de uma só vez.
+ *
+ * As fontes são tratadas em lotes de 64: cada antena guarda uma máscara de
+ * 64 bits com as fontes do lote que já a alcançaram, e um nível é
+ * propagado para o lote inteiro com operações OR sobre as máscaras, ao
+ * custo de uma única BFS. Lotes diferentes correm em threads diferentes
+ * (OpenMP). Não usa o contexto de consulta da thread.
+ * @param grafo Ponteiro para o grafo.
+ * @param fontes Antenas de início.
+ * @param num_fontes Número de fontes.
+ * @param distancias Recebe num_fontes linhas de num_vertices inteiros: o
+ *                   número de saltos da fonte @c s à antena com id @c v fica
+ *                   em distancias[s * num_vertices + v] (-1 se inalcançável).
+ * @return false se faltou memória.
+ */
+bool bfs_multiplas_fontes(Grafo* grafo, Antena** fontes, int num_fontes, int* distancias);
+
 /**
  * @brief Encontra todos os caminhos possíveis entre duas antenas.
  * @param grafo Ponteiro para o grafo.
@@ -98,6 +448,137 @@ void bfs(Grafo* grafo, Antena* inicio, void (*callback)(Antena*));
  */
 void encontrar_caminhos(Grafo* grafo, Antena* origem, Antena* destino, void (*callback)(Antena**, int));
 
+/**
+ * @struct LimitesCaminhos
+ * @brief Limites opcionais para a enumeração de caminhos.
+ */
+typedef struct {
+    int max_saltos;            /**< Máximo de arestas por caminho (0 = sem limite). */
+    long long max_resultados;  /**< Máximo de caminhos a reportar (0 = sem limite). */
+} LimitesCaminhos;
+
+/**
+ * @brief Encontra caminhos entre duas antenas, com limites de profundidade e de resultados.
+ *
+ * Com @p callback a NULL apenas conta os caminhos; com cliques implícitas a
+ * contagem é feita por fórmula, sem enumerar (saturada em LLONG_MAX).
+ * @param grafo Ponteiro para o grafo.
+ * @param origem Antena de origem.
+ * @param destino Antena de destino.
+ * @param limites Limites a aplicar, ou NULL para nenhum.
+ * @param callback Função chamada para cada caminho encontrado, ou NULL.
+ * @return Número de caminhos encontrados (no máximo limites->max_resultados).
+ */
+long long encontrar_caminhos_limitado(Grafo* grafo, Antena* origem, Antena* destino, const LimitesCaminhos* limites,
+                                      void (*callback)(Antena**, int));
+
+/**
+ * @brief Enumera caminhos entre duas antenas em paralelo.
+ *
+ * A árvore de pesquisa é partida por prefixos de caminho, agrupados num
+ * número limitado de tarefas OpenMP distribuídas pelo escalonador de tarefas
+ * do runtime. Cada thread aloca uma só vez o seu bitset de visitados e a sua
+ * pilha. As chamadas ao callback são serializadas, mas a ordem dos caminhos
+ * não é determinística.
+ * @param grafo Ponteiro para o grafo (só de leitura durante a chamada).
+ * @param origem Antena de origem.
+ * @param destino Antena de destino.
+ * @param limites Limites a aplicar, ou NULL para nenhum.
+ * @param callback Função chamada para cada caminho, ou NULL para só contar.
+ * @return Número de caminhos encontrados, ou -1 se faltou memória.
+ */
+long long encontrar_caminhos_paralelo(Grafo* grafo, Antena* origem, Antena* destino, const LimitesCaminhos* limites,
+                                      void (*callback)(Antena**, int));
+
+/**
+ * @brief Encontra um caminho com o menor número de saltos (BFS bidirecional).
+ * @param grafo Ponteiro para o grafo.
+ * @param origem Antena de origem.
+ * @param destino Antena de destino.
+ * @param caminho Recebe o caminho (espaço para num_vertices antenas).
+ * @return Número de antenas do caminho, 0 se não existe, -1 sem memória.
+ */
+int caminho_mais_curto(Grafo* grafo, Antena* origem, Antena* destino, Antena** caminho);
+
+/**
+ * @brief Encontra os k caminhos simples mais curtos (algoritmo de Yen).
+ *
+ * Os caminhos são entregues por número de saltos crescente. Caminhos com o
+ * mesmo número de saltos não saem por nenhuma ordem garantida: dependem dos
+ * desvios que a pesquisa encontra.
+ * @param grafo Ponteiro para o grafo.
+ * @param origem Antena de origem.
+ * @param destino Antena de destino.
+ * @param k Número máximo de caminhos.
+ * @param callback Função chamada para cada caminho, ou NULL.
+ * @return Número de caminhos encontrados (até @p k).
+ */
+int k_caminhos_mais_curtos(Grafo* grafo, Antena* origem, Antena* destino, int k, void (*callback)(Antena**, int));
+
+/**
+ * @brief Custo de uma aresta (ou estimativa de custo) entre duas antenas.
+ * @param a Primeira antena.
+ * @param b Segunda antena.
+ * @param contexto Ponteiro fornecido em CustoArestas::contexto.
+ * @return Custo não negativo.
+ */
+typedef double (*FuncaoCusto)(const Antena* a, const Antena* b, void* contexto);
+
+/**
+ * @struct CustoArestas
+ * @brief Custos das arestas para os caminhos ponderados.
+ */
+typedef struct {
+    FuncaoCusto custo;       /**< Custo de cada aresta (NULL = distancia_euclidiana). */
+    FuncaoCusto heuristica;  /**< Estimativa admissível do custo até ao destino, usada pelo A* (NULL = ver caminho_a_estrela). */
+    void* contexto;          /**< Passado a @c custo e a @c heuristica. */
+} CustoArestas;
+
+/**
+ * @brief Distância euclidiana entre as coordenadas de duas antenas.
+ */
+double distancia_euclidiana(const Antena* a, const Antena* b, void* contexto);
+
+/**
+ * @brief Distância de Manhattan entre as coordenadas de duas antenas.
+ */
+double distancia_manhattan(const Antena* a, const Antena* b, void* contexto);
+
+/**
+ * @brief Encontra o caminho de menor custo (Dijkstra com heap binária).
+ *
+ * Com distancia_euclidiana ou distancia_manhattan o custo satisfaz a
+ * desigualdade triangular e, como cada frequência é uma clique, o ótimo é a
+ * ligação direta: qualquer desvio origem -> w -> destino custa pelo menos o
+ * mesmo. A resposta é então dada sem pesquisa e a heap não é usada. Só com
+ * uma função de custo própria (que pode não ser métrica) é feita a pesquisa,
+ * que expande a frequência inteira de cada antena retirada da heap.
+ * @param grafo Ponteiro para o grafo.
+ * @param origem Antena de origem.
+ * @param destino Antena de destino.
+ * @param custo Custos das arestas, ou NULL para a distância euclidiana.
+ * @param caminho Recebe o caminho (espaço para num_vertices antenas).
+ * @param custo_total Recebe o custo do caminho (pode ser NULL).
+ * @return Número de antenas do caminho, 0 se não existe, -1 sem memória.
+ */
+int caminho_dijkstra(Grafo* grafo, Antena* origem, Antena* destino, const CustoArestas* custo, Antena** caminho,
+                     double* custo_total);
+
+/**
+ * @brief Encontra o caminho de menor custo com A*.
+ *
+ * Igual a caminho_dijkstra, mas a heap é ordenada pelo custo acumulado mais
+ * a heurística até ao destino. Como em caminho_dijkstra, com
+ * distancia_euclidiana ou distancia_manhattan a resposta é a ligação direta,
+ * sem pesquisa: a heurística só é usada com funções de custo próprias. Sem
+ * heurística explícita a pesquisa é a de Dijkstra. Para custos próprios que
+ * nunca são inferiores à distância entre as antenas, distancia_euclidiana é
+ * uma heurística válida.
+ * @return Número de antenas do caminho, 0 se não existe, -1 sem memória.
+ */
+int caminho_a_estrela(Grafo* grafo, Antena* origem, Antena* destino, const CustoArestas* custo, Antena** caminho,
+                      double* custo_total);
+
 /**
  * @brief Lista pares de antenas com frequências diferentes que se interceptam.
  * @param grafo Ponteiro para o grafo.
@@ -107,10 +588,67 @@ void encontrar_caminhos(Grafo* grafo, Antena* origem, Antena* destino, void (*ca
  */
 void listar_intersecoes(Grafo* grafo, char freqA, char freqB, void (*callback)(Antena*, Antena*));
 
+/**
+ * @brief Lista as interseções de todos os pares de frequências numa só chamada.
+ *
+ * Equivale a chamar listar_intersecoes para cada par ordenado de
+ * frequências distintas (freqA, freqB), por ordem crescente dos códigos,
+ * mas indexa as antenas uma única vez e reparte o trabalho pelas threads
+ * (OpenMP), com buffers por thread juntos no fim. O callback é chamado só
+ * depois da pesquisa, sempre a partir da thread que chamou a função.
+ * @param grafo Ponteiro para o grafo (só de leitura durante a chamada).
+ * @param callback Função chamada com cada par, ou NULL para só contar.
+ * @return Número de pares encontrados, ou -1 se faltou memória.
+ */
+long long listar_todas_intersecoes(Grafo* grafo, void (*callback)(Antena*, Antena*));
+
+// ======== COMPONENTES ========
+
+/**
+ * @brief Obtém o id da componente conexa de uma antena.
+ *
+ * As componentes são calculadas por conectar_antenas (e pelo carregamento
+ * binário); cada uma corresponde a uma frequência.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Antena.
+ * @return Id da componente (0 .. num_componentes-1), ou -1 se a antena foi
+ *         adicionada depois do último conectar_antenas.
+ */
+int componente_antena(Grafo* grafo, Antena* antena);
+
+/**
+ * @brief Indica, em O(1), se existe caminho entre duas antenas.
+ * @param grafo Ponteiro para o grafo.
+ * @param a Primeira antena.
+ * @param b Segunda antena.
+ * @return true se @p b é alcançável a partir de @p a.
+ */
+bool alcancavel(Grafo* grafo, Antena* a, Antena* b);
+
+/**
+ * @brief Obtém o tamanho de uma componente conexa.
+ * @param grafo Ponteiro para o grafo.
+ * @param componente Id da componente.
+ * @return Número de antenas da componente (0 se o id é inválido).
+ */
+int tamanho_componente(Grafo* grafo, int componente);
+
+/**
+ * @brief Obtém os membros de uma componente conexa, por ordem de id.
+ * @param grafo Ponteiro para o grafo.
+ * @param componente Id da componente.
+ * @param ids Recebe o ponteiro para os ids dos membros (usar grafo->indice).
+ * @return Número de membros.
+ */
+int membros_componente(Grafo* grafo, int componente, const int** ids);
+
 // ======== FICHEIROS ========
 
 /**
  * @brief Carrega um grafo a partir de um ficheiro de texto.
+ *
+ * Cada carácter diferente de '.' é uma antena; as linhas podem ter qualquer
+ * largura. As dimensões da grelha ficam em grafo->linhas e grafo->colunas.
  * @param filename Caminho do ficheiro.
  * @return Ponteiro para o grafo carregado.
  */
@@ -118,6 +656,10 @@ Grafo* carregar_grafo_arquivo(const char* filename);
 
 /**
  * @brief Guarda o grafo num ficheiro binário.
+ *
+ * Além das antenas são guardados os buckets de frequência, a tabela de
+ * coordenadas e (se materializada) a CSR, para o carregamento não ter de
+ * reconstruir nada.
  * @param grafo Ponteiro para o grafo.
  * @param filename Caminho do ficheiro binário.
  * @return true se foi salvo com sucesso.
@@ -126,33 +668,173 @@ bool salvar_grafo_binario(Grafo* grafo, const char* filename);
 
 /**
  * @brief Carrega o grafo de um ficheiro binário.
+ *
+ * O ficheiro é mapeado em memória e os seus vetores são usados diretamente.
+ * Ficheiros de outra versão ou ordem de bytes são rejeitados; o formato
+ * antigo sem cabeçalho continua a ser lido.
  * @param filename Caminho do ficheiro binário.
  * @return Ponteiro para o grafo carregado.
  */
 Grafo* carregar_grafo_binario(const char* filename);
 
+// ======== MAPAS PARTICIONADOS ========
+
+/**
+ * @brief Divide um mapa de texto em faixas de linhas guardadas em ficheiros separados.
+ *
+ * O texto é mapeado em memória e percorrido uma faixa de cada vez, pelo que
+ * só as antenas de uma faixa estão em memória em cada momento. Cada faixa é
+ * guardada com salvar_grafo_binario em prefixo.<faixa>.bin, e o índice
+ * (ver CabecalhoFaixas) em prefixo.idx.
+ * @param filename Caminho do mapa de texto.
+ * @param prefixo Prefixo dos ficheiros a criar.
+ * @param altura_faixa Número de linhas por faixa.
+ * @return false se o mapa não pôde ser lido ou algum ficheiro escrito.
+ */
+bool particionar_mapa(const char* filename, const char* prefixo, int altura_faixa);
+
+/**
+ * @brief Abre um mapa particionado por particionar_mapa.
+ *
+ * Só o índice é lido; os segmentos são carregados por faixa_mapa.
+ * @param prefixo Prefixo usado em particionar_mapa.
+ * @param orcamento Memória máxima (bytes) dos segmentos carregados. Um
+ *                  segmento maior do que o orçamento é carregado na mesma,
+ *                  sozinho.
+ * @return Ponteiro para o mapa, ou NULL se o índice é inválido.
+ */
+MapaParticionado* abrir_mapa_particionado(const char* prefixo, size_t orcamento);
+
+/**
+ * @brief Fecha um mapa particionado, libertando todos os segmentos carregados.
+ * @param mapa Ponteiro para o mapa.
+ */
+void fechar_mapa_particionado(MapaParticionado* mapa);
+
+/**
+ * @brief Obtém o segmento de uma faixa, carregando-o se for preciso.
+ *
+ * Para respeitar o orçamento podem ser libertados outros segmentos, pelo
+ * que grafos e antenas obtidos antes de outras faixas deixam de ser válidos.
+ * O mapa não pode ser usado por várias threads em simultâneo.
+ * @param mapa Ponteiro para o mapa.
+ * @param faixa Número da faixa.
+ * @return Grafo da faixa, ou NULL se a faixa não existe ou não pôde ser lida.
+ */
+Grafo* faixa_mapa(MapaParticionado* mapa, int faixa);
+
+/**
+ * @brief Procura a antena numa posição de um mapa particionado.
+ * @param mapa Ponteiro para o mapa.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Antena encontrada (válida até ser carregada outra faixa), ou NULL.
+ */
+Antena* encontrar_antena_particionada(MapaParticionado* mapa, int x, int y);
+
+/**
+ * @brief Executa uma BFS num mapa particionado, atravessando as faixas.
+ *
+ * Como a componente de uma antena é a sua frequência, só são carregadas as
+ * faixas que o índice indica terem antenas dessa frequência. A ordem de
+ * visita é a de bfs sobre o mapa completo carregado de texto.
+ * @param mapa Ponteiro para o mapa.
+ * @param x Coordenada X da antena inicial.
+ * @param y Coordenada Y da antena inicial.
+ * @param callback Função chamada para cada antena visitada (a antena só é
+ *                 válida durante a chamada).
+ * @return Número de antenas visitadas, 0 se não há antena em (x,y), -1 se
+ *         um segmento não pôde ser lido.
+ */
+long long bfs_particionada(MapaParticionado* mapa, int x, int y, void (*callback)(Antena*));
+
+/**
+ * @brief Lista interseções entre duas frequências de um mapa particionado.
+ *
+ * As antenas das duas frequências são reunidas, faixa a faixa, num grafo
+ * temporário (fora do orçamento, com memória proporcional a essas antenas)
+ * e passadas a listar_intersecoes, pelo que os pares e a sua ordem são os
+ * do mapa completo, incluindo os que atravessam faixas.
+ * @param mapa Ponteiro para o mapa.
+ * @param freqA Primeira frequência.
+ * @param freqB Segunda frequência.
+ * @param callback Função chamada para cada par (antenas do grafo temporário).
+ * @return false se faltou memória ou um segmento não pôde ser lido.
+ */
+bool listar_intersecoes_particionadas(MapaParticionado* mapa, char freqA, char freqB,
+                                      void (*callback)(Antena*, Antena*));
+
 // ======== MATRIZ ========
 
 /**
  * @brief Imprime a matriz de antenas (formato texto).
+ *
+ * A saída é gerada em bandas de linhas num buffer contíguo e escrita com um
+ * fwrite por banda. Com a grelha densa ativa as linhas são lidas do bitmap,
+ * saltando 64 células livres de cada vez.
  * @param grafo Ponteiro para o grafo.
- * @param linhas Número de linhas.
- * @param colunas Número de colunas.
+ * @param linhas Número de linhas (<= 0 para usar grafo->linhas).
+ * @param colunas Número de colunas (<= 0 para usar grafo->colunas).
  */
 void imprimir_matriz(Grafo* grafo, int linhas, int colunas);
 
 /**
  * @brief Imprime a matriz no formato binário (8 bits por caractere).
+ *
+ * Cada célula é copiada de uma tabela com os 256 padrões "bbbbbbbb ".
  * @param grafo Ponteiro para o grafo.
- * @param linhas Número de linhas.
- * @param colunas Número de colunas.
+ * @param linhas Número de linhas (<= 0 para usar grafo->linhas).
+ * @param colunas Número de colunas (<= 0 para usar grafo->colunas).
  */
 void imprimir_matriz_em_binario(Grafo* grafo, int linhas, int colunas);
 
+// ======== ESTATÍSTICAS ========
+
+/**
+ * @brief Calcula a memória ocupada por cada estrutura do grafo.
+ *
+ * Usa as capacidades alocadas, pelo que está sempre disponível, mesmo sem
+ * GRAFO_ESTATISTICAS.
+ * @param grafo Ponteiro para o grafo.
+ * @param memoria Recebe os bytes por estrutura.
+ */
+void memoria_grafo(Grafo* grafo, MemoriaGrafo* memoria);
+
+/**
+ * @brief Escreve um instantâneo das estatísticas do grafo numa linha JSON.
+ *
+ * Inclui sempre a memória por estrutura; os tempos e contadores só aparecem
+ * quando compilado com GRAFO_ESTATISTICAS.
+ * @param grafo Ponteiro para o grafo.
+ * @param destino Stream de saída.
+ */
+void imprimir_estatisticas(Grafo* grafo, FILE* destino);
+
+/**
+ * @brief Põe a zero os tempos e contadores do grafo (sem efeito sem GRAFO_ESTATISTICAS).
+ * @param grafo Ponteiro para o grafo.
+ */
+void reiniciar_estatisticas(Grafo* grafo);
+
 // ======== UTILITÁRIOS ========
 
+/**
+ * @brief Obtém os vizinhos de uma antena.
+ *
+ * Em modo de cliques implícitas a lista devolvida é o bucket da frequência
+ * e inclui a própria antena, que deve ser ignorada pelo chamador.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Antena de referência.
+ * @param ids Recebe o ponteiro para os ids dos vizinhos (usar grafo->indice).
+ * @return Número de ids em @p ids.
+ */
+int vizinhos_antena(Grafo* grafo, Antena* antena, const int** ids);
+
 /**
  * @brief Encontra uma antena em coordenadas específicas.
+ *
+ * Consulta a tabela de hash de coordenadas mantida por adicionar_antena,
+ * em tempo constante esperado.
  * @param grafo Ponteiro para o grafo.
  * @param x Coordenada X.
  * @param y Coordenada Y.
@@ -160,10 +842,47 @@ void imprimir_matriz_em_binario(Grafo* grafo, int linhas, int colunas);
  */
 Antena* encontrar_antena(Grafo* grafo, int x, int y);
 
+/**
+ * @brief Obtém a frequência da célula (x, y) na grelha densa.
+ * @param grafo Ponteiro para o grafo (com a grelha ativa).
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Frequência da antena na célula, ou '\0' se está livre, fora da
+ *         grelha ou a grelha não está ativa.
+ */
+char frequencia_celula(Grafo* grafo, int x, int y);
+
+/**
+ * @brief Lista as colunas de uma linha ocupadas por uma dada frequência.
+ *
+ * Percorre a linha do plano de frequências 16 células de cada vez (SSE2).
+ * @param grafo Ponteiro para o grafo (com a grelha ativa).
+ * @param frequencia Frequência procurada.
+ * @param y Linha.
+ * @param colunas Recebe as colunas por ordem crescente (espaço para grafo->colunas).
+ * @return Número de colunas encontradas (0 se a grelha não está ativa).
+ */
+int colunas_com_frequencia(Grafo* grafo, char frequencia, int y, int* colunas);
+
 /**
  * @brief Reinicia o estado de visitado de todas as antenas.
+ *
+ * Mantida por compatibilidade: o estado de visita já não vive no grafo e
+ * cada travessia começa sem antenas visitadas, pelo que não tem efeito.
  * @param grafo Ponteiro para o grafo.
  */
 void reiniciar_visitas(Grafo* grafo);
 
+/**
+ * @brief Liberta o estado de visita das consultas feitas pela thread atual.
+ *
+ * Cada thread guarda uma época de visita por antena, criada na primeira
+ * consulta e reutilizada pelas seguintes (em qualquer grafo). As consultas
+ * são reentrantes: uma consulta iniciada dentro do callback de outra, na
+ * mesma thread, usa um contexto próprio (criado na primeira vez que é
+ * preciso) e não perturba a que a chamou. Deve ser chamada por threads de
+ * trabalho antes de terminarem, e nunca dentro de um callback de uma consulta.
+ */
+void libertar_contexto_consulta(void);
+
 #endif // GRAFO_H
\ No newline at end of file
@@ -1,25 +1,217 @@
 #include "grafo.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Stream onde os callbacks escrevem (stdout no menu, ficheiro no modo batch).
+FILE* saida = NULL;
 
 // ----------------------------
 // CALLBACKS PARA EXIBIÇÃO
 // ----------------------------
 
 void mostrar_antena(Antena* a) {
-    printf("Antena %c (%d,%d)\n", a->frequencia, a->x, a->y);
+    fprintf(saida, "Antena %c (%d,%d)\n", a->frequencia, a->x, a->y);
 }
 
 void mostrar_caminho(Antena** caminho, int tamanho) {
     for (int i = 0; i < tamanho; i++) {
-        printf("%c(%d,%d)", caminho[i]->frequencia, caminho[i]->x, caminho[i]->y);
-        if (i < tamanho - 1) printf(" -> ");
+        fprintf(saida, "%c(%d,%d)", caminho[i]->frequencia, caminho[i]->x, caminho[i]->y);
+        if (i < tamanho - 1) fputs(" -> ", saida);
     }
-    printf("\n");
+    fputc('\n', saida);
 }
 
 void mostrar_intersecao(Antena* a, Antena* b) {
-    printf("%c(%d,%d) e %c(%d,%d)\n", a->frequencia, a->x, a->y, b->frequencia, b->x, b->y);
+    fprintf(saida, "%c(%d,%d) e %c(%d,%d)\n", a->frequencia, a->x, a->y, b->frequencia, b->x, b->y);
+}
+
+// ----------------------------
+// MODO BATCH
+// ----------------------------
+
+double agora_us() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int comparar_latencias(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// A grelha densa ocupa cerca de um byte por célula: só é ativada quando há
+// pelo menos uma antena por cada CELULAS_POR_ANTENA células do mapa.
+#define CELULAS_POR_ANTENA 16
+
+Grafo* carregar_mapa(const char* caminho) {
+    size_t n = strlen(caminho);
+    Grafo* grafo = (n >= 4 && strcmp(caminho + n - 4, ".bin") == 0) ? carregar_grafo_binario(caminho)
+                                                                     : carregar_grafo_arquivo(caminho);
+    if (grafo && (long long)grafo->linhas * grafo->colunas <= (long long)grafo->num_vertices * CELULAS_POR_ANTENA) {
+        definir_grelha_densa(grafo, true);
+    }
+    return grafo;
+}
+
+/*
+ * Executa uma consulta do ficheiro de consultas. Formatos aceites:
+ *   ANTENA x y
+ *   DFS x y | BFS x y
+ *   ALCANCE x1 y1 x2 y2
+ *   CURTO x1 y1 x2 y2
+ *   DIJKSTRA x1 y1 x2 y2 [E|M] | ASTAR x1 y1 x2 y2 [E|M] (distância euclidiana ou de Manhattan)
+ *   K x1 y1 x2 y2 k
+ *   CAMINHOS x1 y1 x2 y2 [max_saltos [max_resultados]]
+ *   INTERSECOES freqA freqB | INTERSECOES (todos os pares de frequências)
+ *   INSERIR freq x y | REMOVER x y
+ *   ESTATISTICAS
+ * Devolve 0 se a consulta é inválida.
+ */
+int executar_consulta(Grafo* grafo, const char* linha) {
+    char comando[32];
+    int x1, y1, x2, y2, k;
+    if (sscanf(linha, "%31s", comando) != 1) return 0;
+
+    if (strcmp(comando, "ANTENA") == 0 && sscanf(linha, "%*s %d %d", &x1, &y1) == 2) {
+        Antena* a = encontrar_antena(grafo, x1, y1);
+        if (a) mostrar_antena(a);
+        else fputs("Antena não encontrada.\n", saida);
+    } else if ((strcmp(comando, "DFS") == 0 || strcmp(comando, "BFS") == 0) &&
+               sscanf(linha, "%*s %d %d", &x1, &y1) == 2) {
+        Antena* a = encontrar_antena(grafo, x1, y1);
+        if (!a) fputs("Antena não encontrada.\n", saida);
+        else if (comando[0] == 'D') dfs(grafo, a, mostrar_antena);
+        else bfs(grafo, a, mostrar_antena);
+    } else if ((strcmp(comando, "ALCANCE") == 0 || strcmp(comando, "CURTO") == 0 ||
+                strcmp(comando, "K") == 0 || strcmp(comando, "CAMINHOS") == 0 ||
+                strcmp(comando, "DIJKSTRA") == 0 || strcmp(comando, "ASTAR") == 0) &&
+               sscanf(linha, "%*s %d %d %d %d", &x1, &y1, &x2, &y2) == 4) {
+        Antena* o = encontrar_antena(grafo, x1, y1);
+        Antena* d = encontrar_antena(grafo, x2, y2);
+        if (!o || !d) {
+            fputs("Antena(s) não encontrada(s).\n", saida);
+        } else if (strcmp(comando, "ALCANCE") == 0) {
+            fputs(alcancavel(grafo, o, d) ? "Alcançável\n" : "Inalcançável\n", saida);
+        } else if (comando[0] == 'K') {
+            if (sscanf(linha, "%*s %*d %*d %*d %*d %d", &k) != 1) return 0;
+            k_caminhos_mais_curtos(grafo, o, d, k, mostrar_caminho);
+        } else if (strcmp(comando, "CURTO") == 0) {
+            Antena** caminho = (Antena**)malloc((grafo->num_vertices + 1) * sizeof(Antena*));
+            int tamanho = caminho ? caminho_mais_curto(grafo, o, d, caminho) : 0;
+            if (tamanho > 0) mostrar_caminho(caminho, tamanho);
+            else fputs("Sem caminhos.\n", saida);
+            free(caminho);
+        } else if (strcmp(comando, "DIJKSTRA") == 0 || strcmp(comando, "ASTAR") == 0) {
+            char metrica = 'E';
+            sscanf(linha, "%*s %*d %*d %*d %*d %c", &metrica);
+            CustoArestas custo = {metrica == 'M' ? distancia_manhattan : distancia_euclidiana, NULL, NULL};
+            Antena** caminho = (Antena**)malloc((grafo->num_vertices + 1) * sizeof(Antena*));
+            double total = 0.0;
+            int tamanho = !caminho ? 0
+                          : comando[0] == 'D' ? caminho_dijkstra(grafo, o, d, &custo, caminho, &total)
+                                              : caminho_a_estrela(grafo, o, d, &custo, caminho, &total);
+            if (tamanho > 0) {
+                mostrar_caminho(caminho, tamanho);
+                fprintf(saida, "Custo: %.3f\n", total);
+            } else {
+                fputs("Sem caminhos.\n", saida);
+            }
+            free(caminho);
+        } else {
+            LimitesCaminhos limites = {0, 0};
+            sscanf(linha, "%*s %*d %*d %*d %*d %d %lld", &limites.max_saltos, &limites.max_resultados);
+            encontrar_caminhos_limitado(grafo, o, d, &limites, mostrar_caminho);
+        }
+    } else if (strcmp(comando, "INTERSECOES") == 0) {
+        char f1, f2;
+        int lidos = sscanf(linha, "%*s %c %c", &f1, &f2);
+        if (lidos <= 0) listar_todas_intersecoes(grafo, mostrar_intersecao);
+        else if (lidos == 2) listar_intersecoes(grafo, f1, f2, mostrar_intersecao);
+        else return 0;
+    } else if (strcmp(comando, "INSERIR") == 0) {
+        char f;
+        if (sscanf(linha, "%*s %c %d %d", &f, &x1, &y1) != 3) return 0;
+        fputs(inserir_antena(grafo, f, x1, y1) ? "Antena inserida.\n" : "Erro ao inserir antena.\n", saida);
+    } else if (strcmp(comando, "REMOVER") == 0 && sscanf(linha, "%*s %d %d", &x1, &y1) == 2) {
+        fputs(remover_antena(grafo, encontrar_antena(grafo, x1, y1)) ? "Antena removida.\n"
+                                                                      : "Antena não encontrada.\n", saida);
+    } else if (strcmp(comando, "ESTATISTICAS") == 0) {
+        imprimir_estatisticas(grafo, saida);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Carrega o mapa uma vez e responde a todas as consultas do ficheiro,
+ * escrevendo os resultados (com a latência de cada consulta) num stream
+ * com buffer grande. O resumo vai para stderr.
+ */
+int executar_lote(const char* mapa, const char* consultas, const char* destino) {
+    double t0 = agora_us();
+    Grafo* grafo = carregar_mapa(mapa);
+    if (!grafo) {
+        fprintf(stderr, "Erro ao carregar o mapa %s\n", mapa);
+        return 1;
+    }
+    double t_carga = agora_us() - t0;
+
+    FILE* entrada = fopen(consultas, "r");
+    saida = destino ? fopen(destino, "w") : stdout;
+    if (!entrada || !saida) {
+        fprintf(stderr, "Erro ao abrir %s\n", !entrada ? consultas : destino);
+        if (entrada) fclose(entrada);
+        destruir_grafo(grafo);
+        return 1;
+    }
+    setvbuf(saida, NULL, _IOFBF, 1 << 20);
+
+    char linha[4096];
+    double* latencias = NULL;
+    int num_consultas = 0, capacidade = 0, invalidas = 0;
+    while (fgets(linha, sizeof(linha), entrada)) {
+        linha[strcspn(linha, "\r\n")] = '\0';
+        if (linha[0] == '\0' || linha[0] == '#') continue;
+
+        fprintf(saida, "> %s\n", linha);
+        double inicio = agora_us();
+        int valida = executar_consulta(grafo, linha);
+        double latencia = agora_us() - inicio;
+        if (!valida) {
+            fputs("Consulta inválida.\n", saida);
+            invalidas++;
+        }
+        fprintf(saida, "# %.1f us\n", latencia);
+
+        if (num_consultas == capacidade) {
+            capacidade = capacidade ? capacidade * 2 : 1024;
+            double* mais = (double*)realloc(latencias, capacidade * sizeof(double));
+            if (!mais) break;
+            latencias = mais;
+        }
+        latencias[num_consultas++] = latencia;
+    }
+
+    double total = 0;
+    for (int i = 0; i < num_consultas; i++) total += latencias[i];
+    if (num_consultas > 0) qsort(latencias, num_consultas, sizeof(double), comparar_latencias);
+    fprintf(stderr, "mapa: %d antenas, carregado em %.1f ms\n", grafo->num_vertices, t_carga / 1e3);
+    fprintf(stderr, "consultas: %d (%d inválidas), total %.1f ms\n", num_consultas, invalidas, total / 1e3);
+    if (num_consultas > 0) {
+        fprintf(stderr, "latência (us): p50 %.1f  p99 %.1f  max %.1f\n",
+                latencias[num_consultas / 2], latencias[(int)(num_consultas * 0.99)], latencias[num_consultas - 1]);
+    }
+
+    free(latencias);
+    fclose(entrada);
+    if (saida != stdout) fclose(saida);
+    else fflush(saida);
+    destruir_grafo(grafo);
+    return 0;
 }
 
 // ----------------------------
@@ -38,6 +230,7 @@ void menu() {
     printf("8. Guardar em binario\n");
     printf("9. Carregar de binario\n");
     printf("10. Mostrar matriz em binário\n");
+    printf("11. K caminhos mais curtos entre antenas\n");
     printf("0. Sair\n");
     printf("Escolha: ");
 }
@@ -46,24 +239,31 @@ void menu() {
 // MAIN
 // ----------------------------
 
-int main() {
+int main(int argc, char** argv) {
     Grafo* grafo = NULL;
     int opcao;
 
+    // Modo batch: eda2 <mapa.txt|mapa.bin> <consultas> [saida]
+    if (argc >= 3) return executar_lote(argv[1], argv[2], argc >= 4 ? argv[3] : NULL);
+    saida = stdout;
+
     do {
         menu();
         scanf("%d", &opcao);
 
         switch (opcao) {
             case 1: {
+                char ficheiro[1024];
+                printf("Ficheiro da matriz: ");
+                if (scanf("%1023s", ficheiro) != 1) break;
                 if (grafo) destruir_grafo(grafo);
-                grafo = carregar_grafo_arquivo("C:\\Users\\joaop\\OneDrive\\Ambiente de Trabalho\\Coisas\\EDA2\\matriz.txt");
+                grafo = carregar_mapa(ficheiro);
                 printf(grafo ? "Matriz carregada com sucesso!\n" : "Erro ao carregar a matriz.\n");
                 break;
             }
 
             case 2:
-                if (grafo) imprimir_matriz(grafo, 12, 12);
+                if (grafo) imprimir_matriz(grafo, grafo->linhas, grafo->colunas);
                 else printf("Carregue a matriz primeiro.\n");
                 break;
 
@@ -72,10 +272,12 @@ int main() {
                     Antena* a = grafo->vertices;
                     while (a) {
                         printf("Antena %c (%d,%d) -> ", a->frequencia, a->x, a->y);
-                        Aresta* ar = a->arestas;
-                        while (ar) {
-                            printf("%c(%d,%d) ", ar->destino->frequencia, ar->destino->x, ar->destino->y);
-                            ar = ar->prox;
+                        const int* vizinhos;
+                        int grau = vizinhos_antena(grafo, a, &vizinhos);
+                        for (int k = 0; k < grau; k++) {
+                            Antena* d = grafo->indice[vizinhos[k]];
+                            if (d == a) continue;
+                            printf("%c(%d,%d) ", d->frequencia, d->x, d->y);
                         }
                         printf("\n");
                         a = a->prox;
@@ -142,14 +344,30 @@ int main() {
 
             case 9:
                 if (grafo) destruir_grafo(grafo);
-                grafo = carregar_grafo_binario("grafo.bin");
+                grafo = carregar_mapa("grafo.bin");
                 printf(grafo ? "Grafo carregado do binário.\n" : "Erro ao carregar grafo.\n");
                 break;
             case 10:
-                if (grafo) imprimir_matriz_em_binario(grafo, 12, 12);
+                if (grafo) imprimir_matriz_em_binario(grafo, grafo->linhas, grafo->colunas);
                 else printf("Carregue a matriz primeiro.\n");
                 break;
 
+            case 11: {
+                if (!grafo) { printf("Carregue a matriz primeiro.\n"); break; }
+                int x1, y1, x2, y2, k;
+                printf("Origem (x y): ");
+                scanf("%d %d", &x1, &y1);
+                printf("Destino (x y): ");
+                scanf("%d %d", &x2, &y2);
+                printf("Numero de caminhos: ");
+                scanf("%d", &k);
+                Antena* o = encontrar_antena(grafo, x1, y1);
+                Antena* d = encontrar_antena(grafo, x2, y2);
+                if (!o || !d) printf("Antena(s) não encontrada(s).\n");
+                else if (k_caminhos_mais_curtos(grafo, o, d, k, mostrar_caminho) == 0) printf("Sem caminhos.\n");
+                break;
+            }
+
             case 0:
                 printf("Saindo...\n");
                 break;
@@ -0,0 +1,776 @@
+#include "grafo.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Testes do grafo.
+ *
+ *   ./testes [semente]
+ *
+ * - travessias: DFS, BFS, BFS paralela e enumeração de caminhos comparadas
+ *   com os algoritmos originais (listas de adjacência ligadas), com as
+ *   cliques implícitas e com as arestas materializadas;
+ * - intersecoes: listar_intersecoes e listar_todas_intersecoes comparadas
+ *   com a pesquisa exaustiva original, incluindo a ordem dos pares;
+ * - binario: ida e volta pelo formato binário (e rejeição de um ficheiro
+ *   truncado);
+ * - ponderados: caminho_dijkstra e caminho_a_estrela com um custo não
+ *   métrico (a pesquisa com a heap), comparados com Floyd-Warshall;
+ * - alteracoes: sequências aleatórias de inserir_antena e remover_antena,
+ *   conferindo a cada passo os invariantes do grafo com um modelo simples,
+ *   e no fim uma ida e volta pelo formato binário.
+ *
+ * Escreve uma linha por teste e termina com código 1 se algum falhar.
+ */
+
+#define MAPA_TESTE "testes_mapa.txt"
+#define BINARIO_TESTE "testes_mapa.bin"
+#define MAX_ERROS_REPORTADOS 20
+
+// Símbolos usados como frequências (nenhum é '.', nem espaço, nem fim de linha).
+static const char SIMBOLOS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+int falhas = 0;
+
+// Regista uma falha (as primeiras são descritas no stderr).
+bool verificar(bool condicao, const char* formato, ...) {
+    if (condicao) return true;
+    if (falhas++ < MAX_ERROS_REPORTADOS) {
+        va_list args;
+        va_start(args, formato);
+        fputs("  falhou: ", stderr);
+        vfprintf(stderr, formato, args);
+        fputc('\n', stderr);
+        va_end(args);
+    }
+    return false;
+}
+
+// ----------------------------
+// GERADOR
+// ----------------------------
+
+unsigned long long estado_rng;
+
+unsigned long long proximo_aleatorio() {
+    // xorshift64*
+    estado_rng ^= estado_rng >> 12;
+    estado_rng ^= estado_rng << 25;
+    estado_rng ^= estado_rng >> 27;
+    return estado_rng * 0x2545F4914F6CDD1DULL;
+}
+
+int aleatorio_ate(int n) {
+    return (int)(proximo_aleatorio() % (unsigned long long)n);
+}
+
+// Antena do modelo de referência; o id é a posição no vetor.
+typedef struct {
+    char frequencia;
+    int x, y;
+} Registo;
+
+/*
+ * Gera n antenas num retângulo largura x altura com num_freq frequências.
+ * Cerca de uma em cada dez repete a célula de uma anterior (antenas
+ * sobrepostas), para exercitar a tabela de coordenadas e a grelha.
+ */
+void gerar_registos(Registo* registos, int n, int largura, int altura, int num_freq) {
+    for (int i = 0; i < n; i++) {
+        registos[i].frequencia = SIMBOLOS[aleatorio_ate(num_freq)];
+        if (i > 0 && aleatorio_ate(10) == 0) {
+            const Registo* outro = &registos[aleatorio_ate(i)];
+            registos[i].x = outro->x;
+            registos[i].y = outro->y;
+        } else {
+            registos[i].x = aleatorio_ate(largura);
+            registos[i].y = aleatorio_ate(altura);
+        }
+    }
+}
+
+Grafo* construir_grafo(const Registo* registos, int n, bool materializar) {
+    Grafo* grafo = criar_grafo();
+    definir_arestas_materializadas(grafo, materializar);
+    for (int i = 0; i < n; i++) adicionar_antena(grafo, registos[i].frequencia, registos[i].x, registos[i].y);
+    conectar_antenas(grafo);
+    return grafo;
+}
+
+// ----------------------------
+// SEQUÊNCIAS GRAVADAS PELOS CALLBACKS
+// ----------------------------
+
+typedef struct {
+    int* ids;
+    int tamanho, capacidade;
+} Sequencia;
+
+// Sequência para onde os callbacks estão a gravar.
+Sequencia* gravacao = NULL;
+
+void gravar(int id) {
+    Sequencia* s = gravacao;
+    if (s->tamanho == s->capacidade) {
+        s->capacidade = s->capacidade ? s->capacidade * 2 : 256;
+        s->ids = (int*)realloc(s->ids, (size_t)s->capacidade * sizeof(int));
+        if (!s->ids) {
+            fputs("Sem memória.\n", stderr);
+            exit(2);
+        }
+    }
+    s->ids[s->tamanho++] = id;
+}
+
+void gravar_antena(Antena* a) {
+    gravar(a->id);
+}
+
+void gravar_caminho(Antena** caminho, int tamanho) {
+    for (int i = 0; i < tamanho; i++) gravar(caminho[i]->id);
+    gravar(-1);
+}
+
+void gravar_par(Antena* a, Antena* b) {
+    gravar(a->id);
+    gravar(b->id);
+}
+
+bool mesma_sequencia(const Sequencia* a, const Sequencia* b) {
+    return a->tamanho == b->tamanho && (a->tamanho == 0 || memcmp(a->ids, b->ids, a->tamanho * sizeof(int)) == 0);
+}
+
+// ----------------------------
+// ALGORITMOS ORIGINAIS
+// ----------------------------
+
+/*
+ * Versão original do grafo: cada antena tem uma lista ligada de arestas,
+ * criadas por conectar_original com o ciclo duplo O(V²). As funções abaixo
+ * são as originais, só com os tipos renomeados, e servem de referência.
+ */
+typedef struct NoOriginal NoOriginal;
+
+typedef struct ArestaOriginal {
+    NoOriginal* destino;
+    struct ArestaOriginal* prox;
+} ArestaOriginal;
+
+struct NoOriginal {
+    char frequencia;
+    int x, y;
+    int id;
+    bool visitado;
+    ArestaOriginal* arestas;
+    NoOriginal* prox;
+};
+
+typedef struct {
+    NoOriginal* vertices;
+    NoOriginal** nos;
+    int num_vertices;
+} GrafoOriginal;
+
+void conectar_original(GrafoOriginal* grafo) {
+    NoOriginal* atual = grafo->vertices;
+    while (atual) {
+        NoOriginal* outra = grafo->vertices;
+        while (outra) {
+            if (atual != outra && atual->frequencia == outra->frequencia) {
+                bool conectado = false;
+                ArestaOriginal* aresta = atual->arestas;
+                while (aresta) {
+                    if (aresta->destino == outra) {
+                        conectado = true;
+                        break;
+                    }
+                    aresta = aresta->prox;
+                }
+                if (!conectado) {
+                    ArestaOriginal* nova_aresta = (ArestaOriginal*)malloc(sizeof(ArestaOriginal));
+                    nova_aresta->destino = outra;
+                    nova_aresta->prox = atual->arestas;
+                    atual->arestas = nova_aresta;
+                }
+            }
+            outra = outra->prox;
+        }
+        atual = atual->prox;
+    }
+}
+
+// Cria as antenas por ordem de id (cada uma à cabeça da lista) e liga-as.
+GrafoOriginal construir_original(const Registo* registos, int n) {
+    GrafoOriginal grafo = {NULL, (NoOriginal**)malloc((n > 0 ? n : 1) * sizeof(NoOriginal*)), n};
+    for (int i = 0; i < n; i++) {
+        NoOriginal* nova = (NoOriginal*)malloc(sizeof(NoOriginal));
+        nova->frequencia = registos[i].frequencia;
+        nova->x = registos[i].x;
+        nova->y = registos[i].y;
+        nova->id = i;
+        nova->visitado = false;
+        nova->arestas = NULL;
+        nova->prox = grafo.vertices;
+        grafo.vertices = nova;
+        grafo.nos[i] = nova;
+    }
+    conectar_original(&grafo);
+    return grafo;
+}
+
+void destruir_original(GrafoOriginal* grafo) {
+    for (int i = 0; i < grafo->num_vertices; i++) {
+        ArestaOriginal* aresta = grafo->nos[i]->arestas;
+        while (aresta) {
+            ArestaOriginal* prox = aresta->prox;
+            free(aresta);
+            aresta = prox;
+        }
+        free(grafo->nos[i]);
+    }
+    free(grafo->nos);
+}
+
+void reiniciar_original(GrafoOriginal* grafo) {
+    for (NoOriginal* atual = grafo->vertices; atual; atual = atual->prox) atual->visitado = false;
+}
+
+void dfs_original(NoOriginal* antena) {
+    if (!antena || antena->visitado) return;
+    antena->visitado = true;
+    gravar(antena->id);
+    for (ArestaOriginal* aresta = antena->arestas; aresta; aresta = aresta->prox) dfs_original(aresta->destino);
+}
+
+void bfs_original(GrafoOriginal* grafo, NoOriginal* inicio) {
+    reiniciar_original(grafo);
+    NoOriginal** fila = (NoOriginal**)malloc(grafo->num_vertices * sizeof(NoOriginal*));
+    int inicio_fila = 0, fim_fila = 0;
+    fila[fim_fila++] = inicio;
+    inicio->visitado = true;
+    while (inicio_fila < fim_fila) {
+        NoOriginal* atual = fila[inicio_fila++];
+        gravar(atual->id);
+        for (ArestaOriginal* aresta = atual->arestas; aresta; aresta = aresta->prox) {
+            if (!aresta->destino->visitado) {
+                fila[fim_fila++] = aresta->destino;
+                aresta->destino->visitado = true;
+            }
+        }
+    }
+    free(fila);
+}
+
+void caminhos_original(NoOriginal* atual, NoOriginal* destino, NoOriginal** caminho, int* index) {
+    caminho[(*index)++] = atual;
+    atual->visitado = true;
+    if (atual == destino) {
+        for (int i = 0; i < *index; i++) gravar(caminho[i]->id);
+        gravar(-1);
+    } else {
+        for (ArestaOriginal* aresta = atual->arestas; aresta; aresta = aresta->prox) {
+            if (!aresta->destino->visitado) caminhos_original(aresta->destino, destino, caminho, index);
+        }
+    }
+    (*index)--;
+    atual->visitado = false;
+}
+
+void intersecoes_original(GrafoOriginal* grafo, char freqA, char freqB) {
+    for (NoOriginal* a = grafo->vertices; a; a = a->prox) {
+        if (a->frequencia != freqA) continue;
+        for (NoOriginal* b = grafo->vertices; b; b = b->prox) {
+            if (b->frequencia != freqB) continue;
+            if ((a->x == b->x || a->y == b->y) || (abs(a->x - b->x) == abs(a->y - b->y))) {
+                double distA = sqrt(a->x * a->x + a->y * a->y);
+                double distB = sqrt(b->x * b->x + b->y * b->y);
+                if (fabs(distA - 2 * distB) < 1e-6 || fabs(distB - 2 * distA) < 1e-6) {
+                    gravar(a->id);
+                    gravar(b->id);
+                }
+            }
+        }
+    }
+}
+
+// ----------------------------
+// INVARIANTES
+// ----------------------------
+
+/*
+ * Confere o grafo com o modelo (antenas por id): índice, lista de vértices,
+ * buckets e componentes, vizinhanças, número de arestas, tabela de
+ * coordenadas e, se ativa, a grelha densa.
+ */
+void verificar_invariantes(Grafo* grafo, const Registo* registos, int n, const char* contexto) {
+    if (!verificar(grafo->num_vertices == n, "%s: %d antenas, esperadas %d", contexto, grafo->num_vertices, n)) return;
+
+    Antena* esperada = grafo->vertices;
+    for (int i = n - 1; i >= 0; i--) {
+        Antena* a = grafo->indice[i];
+        verificar(a->id == i, "%s: indice[%d] tem id %d", contexto, i, a->id);
+        verificar(a->frequencia == registos[i].frequencia && a->x == registos[i].x && a->y == registos[i].y,
+                  "%s: antena %d é %c(%d,%d), esperada %c(%d,%d)", contexto, i, a->frequencia, a->x, a->y,
+                  registos[i].frequencia, registos[i].x, registos[i].y);
+        verificar(esperada == a, "%s: lista de vértices fora da ordem dos ids em %d", contexto, i);
+        if (esperada) esperada = esperada->prox;
+    }
+    verificar(esperada == NULL, "%s: lista de vértices com antenas a mais", contexto);
+
+    int* membros = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    long long arestas = 0;
+    int componentes = 0;
+    for (int f = 0; f < 256; f++) {
+        int k = 0;
+        for (int i = 0; i < n; i++) {
+            if ((unsigned char)registos[i].frequencia == f) membros[k++] = i;
+        }
+        if (k == 0) continue;
+        componentes++;
+        arestas += (long long)k * (k - 1);
+
+        const int* ids;
+        int c = componente_antena(grafo, grafo->indice[membros[0]]);
+        int tamanho = membros_componente(grafo, c, &ids);
+        bool iguais = tamanho == k;
+        for (int j = 0; iguais && j < k; j++) iguais = ids[j] == membros[j];
+        verificar(iguais, "%s: bucket de %c com %d ids, esperados %d", contexto, f, tamanho, k);
+
+        // Vizinhos de cada antena: o bucket por ordem de id, sem a própria antena.
+        for (int j = 0; j < k; j++) {
+            int grau = vizinhos_antena(grafo, grafo->indice[membros[j]], &ids);
+            int pos = 0;
+            iguais = true;
+            for (int v = 0; iguais && v < grau; v++) {
+                if (ids[v] == membros[j]) continue;
+                if (pos == j) pos++;
+                iguais = pos < k && ids[v] == membros[pos++];
+            }
+            if (pos == j) pos++;
+            verificar(iguais && pos == k, "%s: vizinhos da antena %d diferentes do bucket de %c", contexto, membros[j], f);
+        }
+    }
+    verificar(grafo->num_componentes == componentes, "%s: %d componentes, esperadas %d", contexto,
+              grafo->num_componentes, componentes);
+    verificar(grafo->num_arestas == arestas, "%s: %lld arestas, esperadas %lld", contexto, grafo->num_arestas, arestas);
+    free(membros);
+
+    // Numa célula partilhada, encontrar_antena devolve a de maior id e a grelha mostra a de menor id.
+    for (int i = 0; i < n; i++) {
+        int mais_recente = i, mais_antiga = i;
+        for (int j = 0; j < n; j++) {
+            if (registos[j].x != registos[i].x || registos[j].y != registos[i].y) continue;
+            if (j > mais_recente) mais_recente = j;
+            if (j < mais_antiga) mais_antiga = j;
+        }
+        Antena* encontrada = encontrar_antena(grafo, registos[i].x, registos[i].y);
+        verificar(encontrada && encontrada->id == mais_recente, "%s: encontrar_antena(%d,%d) devolve %d, esperada %d",
+                  contexto, registos[i].x, registos[i].y, encontrada ? encontrada->id : -1, mais_recente);
+        if (grafo->grelha.frequencias) {
+            char f = frequencia_celula(grafo, registos[i].x, registos[i].y);
+            verificar(f == registos[mais_antiga].frequencia, "%s: grelha em (%d,%d) tem %c, esperada %c", contexto,
+                      registos[i].x, registos[i].y, f ? f : '0', registos[mais_antiga].frequencia);
+        }
+    }
+}
+
+// ----------------------------
+// TESTES
+// ----------------------------
+
+/*
+ * Compara dfs, bfs e bfs_paralela a partir de todas as antenas com as
+ * versões originais, e encontrar_caminhos para alguns pares de antenas.
+ */
+void comparar_travessias(Grafo* grafo, const Registo* registos, int n, const char* contexto) {
+    GrafoOriginal original = construir_original(registos, n);
+    NoOriginal** caminho = (NoOriginal**)malloc((n > 0 ? n : 1) * sizeof(NoOriginal*));
+    Sequencia obtida = {NULL, 0, 0}, esperada = {NULL, 0, 0};
+
+    for (int i = 0; i < n; i++) {
+        for (int tipo = 0; tipo < 3; tipo++) {
+            obtida.tamanho = esperada.tamanho = 0;
+            gravacao = &obtida;
+            if (tipo == 0) dfs(grafo, grafo->indice[i], gravar_antena);
+            else if (tipo == 1) bfs(grafo, grafo->indice[i], gravar_antena);
+            else bfs_paralela(grafo, grafo->indice[i], NULL, gravar_antena);
+            gravacao = &esperada;
+            reiniciar_original(&original);
+            if (tipo == 0) dfs_original(original.nos[i]);
+            else bfs_original(&original, original.nos[i]);
+            verificar(mesma_sequencia(&obtida, &esperada), "%s: %s a partir de %d difere da original", contexto,
+                      tipo == 0 ? "dfs" : tipo == 1 ? "bfs" : "bfs_paralela", i);
+        }
+    }
+
+    // Caminhos só em classes pequenas (o número cresce com o fatorial do tamanho).
+    for (int t = 0; t < 20 && n > 0; t++) {
+        int a = aleatorio_ate(n), b = aleatorio_ate(n);
+        const int* ids;
+        if (membros_componente(grafo, componente_antena(grafo, grafo->indice[a]), &ids) > 7) continue;
+        obtida.tamanho = esperada.tamanho = 0;
+        gravacao = &obtida;
+        encontrar_caminhos(grafo, grafo->indice[a], grafo->indice[b], gravar_caminho);
+        gravacao = &esperada;
+        reiniciar_original(&original);
+        int index = 0;
+        caminhos_original(original.nos[a], original.nos[b], caminho, &index);
+        verificar(mesma_sequencia(&obtida, &esperada), "%s: caminhos de %d a %d diferem dos originais", contexto, a, b);
+    }
+
+    // Uma antena inicial inexistente (por exemplo, um encontrar_antena sem resultado) não visita nada.
+    int* niveis = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    obtida.tamanho = 0;
+    gravacao = &obtida;
+    dfs(grafo, NULL, gravar_antena);
+    bfs(grafo, NULL, gravar_antena);
+    bool ok = bfs_paralela(grafo, NULL, niveis, gravar_antena);
+    for (int i = 0; i < n; i++) ok = ok && niveis[i] == -1;
+    verificar(ok && obtida.tamanho == 0, "%s: travessia a partir de NULL visitou antenas", contexto);
+    free(niveis);
+
+    free(obtida.ids);
+    free(esperada.ids);
+    free(caminho);
+    destruir_original(&original);
+}
+
+void testar_travessias(void) {
+    for (int caso = 0; caso < 6; caso++) {
+        int n = 20 + aleatorio_ate(150);
+        int num_freq = 1 + aleatorio_ate(caso < 3 ? 4 : 30);
+        Registo* registos = (Registo*)malloc(n * sizeof(Registo));
+        gerar_registos(registos, n, 40, 30, num_freq);
+        for (int materializar = 0; materializar < 2; materializar++) {
+            char contexto[64];
+            snprintf(contexto, sizeof(contexto), "travessias caso %d%s", caso, materializar ? " (CSR)" : "");
+            Grafo* grafo = construir_grafo(registos, n, materializar);
+            verificar_invariantes(grafo, registos, n, contexto);
+            comparar_travessias(grafo, registos, n, contexto);
+            destruir_grafo(grafo);
+        }
+        free(registos);
+    }
+}
+
+void testar_intersecoes(void) {
+    for (int caso = 0; caso < 6; caso++) {
+        int n = 50 + aleatorio_ate(300);
+        int num_freq = 2 + aleatorio_ate(6);
+        Registo* registos = (Registo*)malloc(n * sizeof(Registo));
+        // Mapas pequenos para haver muitas antenas alinhadas com a origem.
+        gerar_registos(registos, n, 24 + caso * 8, 24 + caso * 8, num_freq);
+        Grafo* grafo = construir_grafo(registos, n, false);
+        GrafoOriginal original = construir_original(registos, n);
+        Sequencia obtida = {NULL, 0, 0}, esperada = {NULL, 0, 0}, todas = {NULL, 0, 0};
+
+        // listar_todas_intersecoes equivale a todos os pares ordenados de frequências distintas,
+        // por ordem crescente dos códigos (as primeiras letras de SIMBOLOS já estão por essa ordem).
+        for (int a = 0; a < num_freq; a++) {
+            for (int b = 0; b < num_freq; b++) {
+                if (a == b) continue;
+                obtida.tamanho = 0;
+                gravacao = &obtida;
+                listar_intersecoes(grafo, SIMBOLOS[a], SIMBOLOS[b], gravar_par);
+                // Os pares originais são acumulados para comparar no fim com listar_todas_intersecoes.
+                int inicio = esperada.tamanho;
+                gravacao = &esperada;
+                intersecoes_original(&original, SIMBOLOS[a], SIMBOLOS[b]);
+                Sequencia par = {esperada.ids + inicio, esperada.tamanho - inicio, 0};
+                verificar(mesma_sequencia(&obtida, &par), "caso %d: intersecoes %c-%c diferem das originais", caso,
+                          SIMBOLOS[a], SIMBOLOS[b]);
+            }
+        }
+        gravacao = &todas;
+        long long total = listar_todas_intersecoes(grafo, gravar_par);
+        verificar(total * 2 == todas.tamanho && mesma_sequencia(&todas, &esperada),
+                  "caso %d: listar_todas_intersecoes (%lld pares) difere dos pares originais (%d)", caso, total,
+                  esperada.tamanho / 2);
+
+        free(obtida.ids);
+        free(esperada.ids);
+        free(todas.ids);
+        destruir_original(&original);
+        destruir_grafo(grafo);
+        free(registos);
+    }
+}
+
+// Escreve o mapa de texto das antenas (sem sobreposições: cada célula guarda uma letra).
+bool escrever_mapa(const char* nome, char** celulas, int largura, int altura) {
+    FILE* file = fopen(nome, "wb");
+    if (!file) return false;
+    for (int y = 0; y < altura; y++) {
+        fwrite(celulas[y], 1, (size_t)largura, file);
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+void testar_binario(void) {
+    for (int caso = 0; caso < 4; caso++) {
+        int largura = 30 + aleatorio_ate(40), altura = 20 + aleatorio_ate(30);
+        int num_freq = 1 + aleatorio_ate(20);
+        char** celulas = (char**)malloc(altura * sizeof(char*));
+        for (int y = 0; y < altura; y++) {
+            celulas[y] = (char*)malloc(largura);
+            for (int x = 0; x < largura; x++) celulas[y][x] = aleatorio_ate(5) == 0 ? SIMBOLOS[aleatorio_ate(num_freq)] : '.';
+        }
+        if (!verificar(escrever_mapa(MAPA_TESTE, celulas, largura, altura), "não foi possível escrever %s", MAPA_TESTE)) {
+            return;
+        }
+
+        // O carregamento de texto dá as antenas por ordem de leitura.
+        Registo* registos = (Registo*)malloc(largura * altura * sizeof(Registo));
+        int n = 0;
+        for (int y = 0; y < altura; y++) {
+            for (int x = 0; x < largura; x++) {
+                if (celulas[y][x] != '.') registos[n++] = (Registo){celulas[y][x], x, y};
+            }
+        }
+        Grafo* texto = carregar_grafo_arquivo(MAPA_TESTE);
+        char contexto[64];
+        snprintf(contexto, sizeof(contexto), "binário caso %d (texto)", caso);
+        if (!verificar(texto != NULL, "%s: carregar_grafo_arquivo falhou", contexto)) return;
+        verificar(texto->linhas == altura && texto->colunas == largura, "%s: dimensões %dx%d", contexto, texto->linhas,
+                  texto->colunas);
+        verificar_invariantes(texto, registos, n, contexto);
+
+        bool materializar = caso % 2 == 1;
+        definir_arestas_materializadas(texto, materializar);
+        if (caso >= 2) definir_grelha_densa(texto, true);
+        verificar(salvar_grafo_binario(texto, BINARIO_TESTE), "%s: salvar_grafo_binario falhou", contexto);
+        Grafo* binario = carregar_grafo_binario(BINARIO_TESTE);
+        snprintf(contexto, sizeof(contexto), "binário caso %d (ida e volta)", caso);
+        if (verificar(binario != NULL, "%s: carregar_grafo_binario falhou", contexto)) {
+            verificar(binario->linhas == altura && binario->colunas == largura, "%s: dimensões %dx%d", contexto,
+                      binario->linhas, binario->colunas);
+            verificar(binario->arestas_materializadas == materializar, "%s: materialização perdida", contexto);
+            verificar_invariantes(binario, registos, n, contexto);
+            comparar_travessias(binario, registos, n, contexto);
+
+            // O grafo mapeado continua a aceitar alterações (copiando o que vem do ficheiro).
+            if (n == 0) registos[n++] = (Registo){SIMBOLOS[0], 0, 0}, inserir_antena(binario, SIMBOLOS[0], 0, 0);
+            Antena* removida = binario->indice[n / 2];
+            registos[n / 2] = registos[n - 1];
+            verificar(remover_antena(binario, removida), "%s: remover_antena falhou", contexto);
+            registos[n - 1] = (Registo){SIMBOLOS[0], largura + 1, altura + 2};
+            verificar(inserir_antena(binario, SIMBOLOS[0], largura + 1, altura + 2) != NULL,
+                      "%s: inserir_antena falhou", contexto);
+            snprintf(contexto, sizeof(contexto), "binário caso %d (alterado)", caso);
+            verificar_invariantes(binario, registos, n, contexto);
+            destruir_grafo(binario);
+        }
+
+        // Um ficheiro truncado é rejeitado.
+        FILE* file = fopen(BINARIO_TESTE, "rb");
+        long tamanho = 0;
+        char* dados = NULL;
+        if (file) {
+            fseek(file, 0, SEEK_END);
+            tamanho = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            dados = (char*)malloc(tamanho);
+            if (dados && fread(dados, 1, tamanho, file) != (size_t)tamanho) tamanho = 0;
+            fclose(file);
+        }
+        file = dados && tamanho > 0 ? fopen(BINARIO_TESTE, "wb") : NULL;
+        if (file) {
+            fwrite(dados, 1, (size_t)tamanho / 2, file);
+            fclose(file);
+            Grafo* truncado = carregar_grafo_binario(BINARIO_TESTE);
+            verificar(truncado == NULL, "binário caso %d: ficheiro truncado aceite", caso);
+            if (truncado) destruir_grafo(truncado);
+        }
+        free(dados);
+
+        destruir_grafo(texto);
+        free(registos);
+        for (int y = 0; y < altura; y++) free(celulas[y]);
+        free(celulas);
+    }
+    remove(MAPA_TESTE);
+    remove(BINARIO_TESTE);
+}
+
+/*
+ * Custo não métrico (quadrado da distância): um desvio pode ser mais barato
+ * do que a ligação direta, pelo que caminho_dijkstra e caminho_a_estrela
+ * fazem a pesquisa com a heap. O custo é comparado com Floyd-Warshall sobre
+ * as arestas do grafo e o caminho devolvido tem de ser válido.
+ */
+double distancia_quadrada(const Antena* a, const Antena* b, void* contexto) {
+    (void)contexto;
+    double dx = a->x - b->x, dy = a->y - b->y;
+    return dx * dx + dy * dy;
+}
+
+// Com m saltos a soma dos quadrados é pelo menos D²/m, e m é menor do que o número de antenas.
+double heuristica_quadrada(const Antena* a, const Antena* b, void* contexto) {
+    return distancia_quadrada(a, b, NULL) / *(const int*)contexto;
+}
+
+void testar_ponderados(void) {
+    int desvios = 0;
+    for (int caso = 0; caso < 6; caso++) {
+        int n = 20 + aleatorio_ate(100);
+        int num_freq = 1 + aleatorio_ate(4);
+        Registo* registos = (Registo*)malloc(n * sizeof(Registo));
+        gerar_registos(registos, n, 60, 60, num_freq);
+        Grafo* grafo = construir_grafo(registos, n, caso % 2 == 1);
+        char contexto[64];
+        snprintf(contexto, sizeof(contexto), "ponderados caso %d", caso);
+
+        // Custos mínimos de referência (-1 se não há caminho).
+        double* minimo = (double*)malloc((size_t)n * n * sizeof(double));
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                bool aresta = registos[i].frequencia == registos[j].frequencia;
+                minimo[i * n + j] = i == j ? 0 : aresta ? distancia_quadrada(grafo->indice[i], grafo->indice[j], NULL) : -1;
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            for (int i = 0; i < n; i++) {
+                if (minimo[i * n + k] < 0) continue;
+                for (int j = 0; j < n; j++) {
+                    if (minimo[k * n + j] < 0) continue;
+                    double via = minimo[i * n + k] + minimo[k * n + j];
+                    if (minimo[i * n + j] < 0 || via < minimo[i * n + j]) minimo[i * n + j] = via;
+                }
+            }
+        }
+
+        Antena** caminho = (Antena**)malloc(n * sizeof(Antena*));
+        CustoArestas dijkstra = {distancia_quadrada, NULL, NULL};
+        CustoArestas a_estrela = {distancia_quadrada, heuristica_quadrada, &n};
+        for (int t = 0; t < 60; t++) {
+            int a = aleatorio_ate(n), b = aleatorio_ate(n);
+            for (int tipo = 0; tipo < 2; tipo++) {
+                const char* nome = tipo == 0 ? "caminho_dijkstra" : "caminho_a_estrela";
+                double custo = -1;
+                int tamanho = tipo == 0
+                                  ? caminho_dijkstra(grafo, grafo->indice[a], grafo->indice[b], &dijkstra, caminho, &custo)
+                                  : caminho_a_estrela(grafo, grafo->indice[a], grafo->indice[b], &a_estrela, caminho, &custo);
+                double esperado = minimo[a * n + b];
+                if (esperado < 0) {
+                    verificar(tamanho == 0, "%s: %s de %d a %d devolveu %d antenas sem haver caminho", contexto, nome, a,
+                              b, tamanho);
+                    continue;
+                }
+                bool valido = tamanho > 0 && caminho[0] == grafo->indice[a] && caminho[tamanho - 1] == grafo->indice[b];
+                double soma = 0;
+                for (int k = 1; valido && k < tamanho; k++) {
+                    valido = caminho[k]->frequencia == caminho[k - 1]->frequencia;
+                    soma += distancia_quadrada(caminho[k - 1], caminho[k], NULL);
+                }
+                verificar(valido && soma - esperado < 1e-6 && esperado - soma < 1e-6 && custo == soma,
+                          "%s: %s de %d a %d custa %g (caminho de %d antenas, soma %g), esperado %g", contexto, nome, a,
+                          b, custo, tamanho, soma, esperado);
+                if (tamanho > 2) desvios++;
+            }
+        }
+
+        free(caminho);
+        free(minimo);
+        destruir_grafo(grafo);
+        free(registos);
+    }
+    // Sem desvios o teste não distinguiria a pesquisa da ligação direta.
+    verificar(desvios > 0, "ponderados: nenhum caminho ótimo com desvio");
+}
+
+/*
+ * Sequências aleatórias de inserções e remoções, com o modelo atualizado
+ * pela mesma regra de remover_antena (a antena de maior id fica com o id
+ * da removida). Os invariantes são conferidos a cada passo e as travessias
+ * de tempos a tempos.
+ */
+void testar_alteracoes(void) {
+    const int passos = 600;
+    for (int caso = 0; caso < 6; caso++) {
+        bool materializar = caso % 2 == 1;
+        int num_freq = caso < 2 ? 2 : caso < 4 ? 8 : 30;
+        int largura = 25, altura = 20;
+        int n = 30 + aleatorio_ate(60);
+        Registo* registos = (Registo*)malloc((n + passos) * sizeof(Registo));
+        gerar_registos(registos, n, largura, altura, num_freq);
+        Grafo* grafo = construir_grafo(registos, n, materializar);
+        if (caso >= 4) definir_grelha_densa(grafo, true);
+
+        for (int passo = 0; passo < passos && falhas < MAX_ERROS_REPORTADOS; passo++) {
+            char contexto[96];
+            bool inserir = n == 0 || aleatorio_ate(100) < (passo < passos / 2 ? 60 : 40);
+            if (inserir) {
+                Registo novo;
+                gerar_registos(&novo, 1, largura, altura, num_freq);
+                // Sobrepõe-se a uma antena existente com alguma frequência.
+                if (n > 0 && aleatorio_ate(5) == 0) {
+                    const Registo* outro = &registos[aleatorio_ate(n)];
+                    novo.x = outro->x;
+                    novo.y = outro->y;
+                }
+                Antena* antena = inserir_antena(grafo, novo.frequencia, novo.x, novo.y);
+                verificar(antena && antena->id == n, "alterações caso %d passo %d: inserir_antena falhou", caso, passo);
+                registos[n++] = novo;
+                snprintf(contexto, sizeof(contexto), "alterações caso %d passo %d (inserir %c(%d,%d))", caso, passo,
+                         novo.frequencia, novo.x, novo.y);
+            } else {
+                int id = aleatorio_ate(n);
+                verificar(remover_antena(grafo, grafo->indice[id]), "alterações caso %d passo %d: remover_antena falhou",
+                          caso, passo);
+                registos[id] = registos[n - 1];
+                n--;
+                snprintf(contexto, sizeof(contexto), "alterações caso %d passo %d (remover %d)", caso, passo, id);
+            }
+            verificar_invariantes(grafo, registos, n, contexto);
+            if (passo % 50 == 49) comparar_travessias(grafo, registos, n, contexto);
+        }
+        verificar(!remover_antena(grafo, NULL), "alterações caso %d: remover_antena(NULL) aceite", caso);
+
+        // O formato binário junta de novo os buckets e as linhas que passaram para blocos próprios.
+        char contexto[64];
+        snprintf(contexto, sizeof(contexto), "alterações caso %d (ida e volta)", caso);
+        verificar(salvar_grafo_binario(grafo, BINARIO_TESTE), "%s: salvar_grafo_binario falhou", contexto);
+        Grafo* binario = carregar_grafo_binario(BINARIO_TESTE);
+        if (verificar(binario != NULL, "%s: carregar_grafo_binario falhou", contexto)) {
+            verificar(binario->arestas_materializadas == materializar, "%s: materialização perdida", contexto);
+            verificar_invariantes(binario, registos, n, contexto);
+            comparar_travessias(binario, registos, n, contexto);
+            destruir_grafo(binario);
+        }
+
+        destruir_grafo(grafo);
+        free(registos);
+    }
+    remove(BINARIO_TESTE);
+}
+
+// ----------------------------
+// MAIN
+// ----------------------------
+
+int main(int argc, char** argv) {
+    estado_rng = argc > 1 ? strtoull(argv[1], NULL, 10) : 1;
+    if (estado_rng == 0) estado_rng = 1;
+
+    struct {
+        const char* nome;
+        void (*executar)(void);
+    } testes[] = {
+        {"travessias", testar_travessias},
+        {"intersecoes", testar_intersecoes},
+        {"binario", testar_binario},
+        {"ponderados", testar_ponderados},
+        {"alteracoes", testar_alteracoes},
+    };
+    for (size_t t = 0; t < sizeof(testes) / sizeof(testes[0]); t++) {
+        int antes = falhas;
+        testes[t].executar();
+        printf("%-12s %s\n", testes[t].nome, falhas == antes ? "ok" : "FALHOU");
+        fflush(stdout);
+    }
+    libertar_contexto_consulta();
+    return falhas > 0 ? 1 : 0;
+}